@@ -1,4 +1,5 @@
 // Graph and Dijkstra C++ implementation
+// Build with: g++ -std=c++11 -O2 -pthread dijkstra_shortest_path.cpp
 
 #include <iostream>
 #include <iomanip>
@@ -9,8 +10,16 @@
 #include <set>
 #include <map>
 #include <list>
-#include <queue>
+#include <algorithm>
 #include <utility>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <ctime>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <cstdint>
 
 // ===================================================================== 
 // Definitions of the smallest components: Edge as a struct with a cost
@@ -28,6 +37,139 @@ struct Node{
     std::map<int, Edge> edges;
 };
 
+// An undirected edge as it comes out of a generator or an edge list
+struct WeightedEdge{
+  int from;
+  int to;
+  double cost;
+};
+
+// Orients every edge as from < to, drops self loops, then sorts the list
+// by (from, to) and keeps only the first copy of each edge, like repeated
+// Graph::addEdge calls would. The result feeds the bulk constructors of
+// Graph and CSRGraph in the order they append fastest.
+void sortEdgeList(std::vector<WeightedEdge> &edges){
+    
+    size_t kept = 0;
+    for (size_t k = 0; k < edges.size(); ++k){
+        WeightedEdge we = edges[k];
+        if (we.from == we.to) continue;
+        if (we.from > we.to) std::swap(we.from, we.to);
+        edges[kept++] = we;
+    }
+    edges.resize(kept);
+    
+    std::stable_sort(edges.begin(), edges.end(), [](const WeightedEdge& a, const WeightedEdge& b){
+        return (a.from < b.from) || (a.from == b.from && a.to < b.to);
+    });
+    
+    auto last = std::unique(edges.begin(), edges.end(), [](const WeightedEdge& a, const WeightedEdge& b){
+        return a.from == b.from && a.to == b.to;
+    });
+    edges.erase(last, edges.end());
+}
+
+// Reads "x y cost" triples until the end of the stream, returns how many.
+int readEdgeList(std::istream &in, std::vector<WeightedEdge> &edges){
+    
+    int count = 0;
+    WeightedEdge we;
+    while (in >> we.from >> we.to >> we.cost){
+        edges.push_back(we);
+        count++;
+    }
+    return count;
+}
+
+// ===================================================================== 
+// Read-only views used by Graph to hand out its vertices and edges
+// without copying them: EdgeRange walks the Edge values of a Node map
+// in place, NeighborRange walks their keys and VertexRange counts the 
+// dense vertex ids 0 .. V-1. A view is invalidated by any mutation of 
+// the Node it refers to.
+// =====================================================================
+
+class EdgeRange{
+    public:
+        class iterator{
+            public:
+                iterator(std::map<int, Edge>::const_iterator it) : it(it) {}
+                const Edge& operator*() const { return it->second; }
+                const Edge* operator->() const { return &(it->second); }
+                iterator& operator++() { ++it; return *this; }
+                bool operator==(const iterator& o) const { return it == o.it; }
+                bool operator!=(const iterator& o) const { return it != o.it; }
+            private:
+                std::map<int, Edge>::const_iterator it;
+        };
+        EdgeRange(const std::map<int, Edge> &edges) : edges(&edges) {}
+        iterator begin() const { return iterator(edges->begin()); }
+        iterator end() const { return iterator(edges->end()); }
+        int size() const { return static_cast<int>(edges->size()); }
+        
+    private:
+        const std::map<int, Edge>* edges;
+};
+
+class NeighborRange{
+    public:
+        class iterator{
+            public:
+                iterator(std::map<int, Edge>::const_iterator it) : it(it) {}
+                int operator*() const { return it->first; }
+                iterator& operator++() { ++it; return *this; }
+                bool operator==(const iterator& o) const { return it == o.it; }
+                bool operator!=(const iterator& o) const { return it != o.it; }
+            private:
+                std::map<int, Edge>::const_iterator it;
+        };
+        NeighborRange(const std::map<int, Edge> &edges) : edges(&edges) {}
+        iterator begin() const { return iterator(edges->begin()); }
+        iterator end() const { return iterator(edges->end()); }
+        int size() const { return static_cast<int>(edges->size()); }
+        
+    private:
+        const std::map<int, Edge>* edges;
+};
+
+class VertexRange{
+    public:
+        class iterator{
+            public:
+                iterator(int n) : n(n) {}
+                int operator*() const { return n; }
+                iterator& operator++() { ++n; return *this; }
+                bool operator==(const iterator& o) const { return n == o.n; }
+                bool operator!=(const iterator& o) const { return n != o.n; }
+            private:
+                int n;
+        };
+        VertexRange(int numVertices) : numV(numVertices) {}
+        iterator begin() const { return iterator(0); }
+        iterator end() const { return iterator(numV); }
+        int size() const { return numV; }
+        
+    private:
+        int numV;
+};
+
+// ===================================================================== 
+// GraphObserver: interface for objects that keep results derived from a
+// Graph and want to hear about its edits. The Graph calls it after the
+// change is applied; a missing edge has cost infinity, so an insertion
+// goes from infinity to c and a removal from c to infinity. Assigning
+// a whole new graph is not an edit: it calls graphReplaced instead, and
+// the observers stay subscribed to the assigned Graph.
+// ===================================================================== 
+
+class GraphObserver{
+    public:
+        virtual ~GraphObserver() {}
+        virtual void vertexAdded(int x) = 0;
+        virtual void edgeChanged(int x, int y, double oldCost, double newCost) = 0;
+        virtual void graphReplaced() = 0;
+};
+
 // ===================================================================== 
 // Graph Class
 // ===================================================================== 
@@ -37,13 +179,19 @@ class Graph{
   public:
     Graph();
     Graph(int numVertices); 
+    Graph(int numVertices, const std::vector<WeightedEdge> &edges); // bulk build from an edge list
+    Graph(const Graph &other); // copies the edges, not the observers
+    Graph& operator=(const Graph &other);
+    void subscribe(GraphObserver *observer); // observer is told about every edit from now on
+    void unsubscribe(GraphObserver *observer);
     void addVertex(); // add an additional vertex to the graph.
-    std::vector<int> getVertices(); // return a vector of vertices in the graph
+    VertexRange getVertices() const; // return a view of the vertices in the graph
     bool adjacent(int x, int y); // tests whether there is an edge from node x to node y.
-    std::vector<int> neighbors(int x); // lists all nodes y such that there is an edge from x to y.
+    NeighborRange neighbors(int x) const; // view of all nodes y such that there is an edge from x to y.
     void addEdge(int x, int y, double c); // adds the edge from x to y, if it is not there.
     void removeEdge(int x, int y); // removes the edge from x to y, if it is there.
-    std::map<int, Edge> getEdges(int x);
+    std::map<int, Edge> getEdges(int x); // returns a copy of the edges of x, prefer edges(x).
+    EdgeRange edges(int x) const; // view of the edges leaving x, no copy is made.
     double getEdgeCost(int x, int y); // returns the value associated to the edge (x,y).
     void setEdgeCost(int x, int y, double c); // sets the value associated to the edge (x,y) to v.
     int V() const; // returns the number of vertices in the graph
@@ -55,6 +203,7 @@ class Graph{
     int numV; // number of Vertices
     int numE; // number of Edges
     std::vector<Node> adjList; // adjucency list representing the Graph
+    std::vector<GraphObserver*> observers; // notified after every edit
     
 };
 
@@ -76,31 +225,81 @@ Graph::Graph(int numVertices)
   }
 }
 
+// Every edge is appended with an end() hint, which is O(1) per edge 
+// when each node receives its neighbors in increasing order (e.g. the 
+// lists from sortEdgeList or Montecarlo::randomEdges); any other order
+// is still correct and duplicated edges are ignored like in addEdge.
+Graph::Graph(int numVertices, const std::vector<WeightedEdge> &edges)
+{
+  numV = 0;
+  numE = 0;
+  adjList.clear();
+  adjList.reserve(numVertices);
+  
+  for(int i = 0; i < numVertices; ++i){
+    addVertex();
+  }
+  
+  for (const WeightedEdge& we : edges){
+      std::map<int, Edge> &fromEdges = adjList[we.from].edges;
+      size_t before = fromEdges.size();
+      Edge xy = {we.to, we.cost}, yx = {we.from, we.cost};
+      fromEdges.emplace_hint(fromEdges.end(), we.to, xy);
+      if (fromEdges.size() != before){
+          adjList[we.to].edges.emplace_hint(adjList[we.to].edges.end(), we.from, yx);
+          numE+=2;
+      }
+  }
+}
+
+Graph::Graph(const Graph &other)
+{
+  numV = other.numV;
+  numE = other.numE;
+  adjList = other.adjList;
+}
+
+Graph& Graph::operator=(const Graph &other)
+{
+  numV = other.numV;
+  numE = other.numE;
+  adjList = other.adjList;
+  for (GraphObserver* o : observers){
+      o->graphReplaced();
+  }
+  return *this;
+}
+
+void Graph::subscribe(GraphObserver *observer){
+    if (std::find(observers.begin(), observers.end(), observer) == observers.end()){
+        observers.push_back(observer);
+    }
+}
+
+void Graph::unsubscribe(GraphObserver *observer){
+    observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
 void Graph::addVertex(){
   Node newNode;
   newNode.n = numV;
   adjList.push_back(newNode);
   numV++;
+  for (GraphObserver* o : observers){
+      o->vertexAdded(numV - 1);
+  }
 }
 
-std::vector<int> Graph::getVertices(){
-    std::vector<int> vec;
-    for(auto it = adjList.begin(); it != adjList.end(); ++it){
-        vec.push_back((*it).n);
-    }
-    return vec;
+VertexRange Graph::getVertices() const{
+    return VertexRange(numV);
 }
 
 bool Graph::adjacent(int x, int y){
     return adjList[x].edges.count(y);
 }
 
-std::vector<int> Graph::neighbors(int x){
-    std::vector<int> vec;
-    for(auto it = adjList[x].edges.begin(); it != adjList[x].edges.end(); ++it){
-        vec.push_back(it->first);
-    }
-    return vec;
+NeighborRange Graph::neighbors(int x) const{
+    return NeighborRange(adjList[x].edges);
 }
 
 void Graph::addEdge(int x, int y, double c){
@@ -110,15 +309,22 @@ void Graph::addEdge(int x, int y, double c){
         adjList[x].edges.insert({y, xy});
         adjList[y].edges.insert({x, yx});
         numE+=2;        
+        for (GraphObserver* o : observers){
+            o->edgeChanged(x, y, std::numeric_limits<double>::infinity(), c);
+        }
     }
 }
 
 void Graph::removeEdge(int x, int y){
     
     if (adjList[x].edges.count(y)){
+        double c = adjList[x].edges[y].cost;
         adjList[x].edges.erase(y);
         adjList[y].edges.erase(x);
         numE-=2;
+        for (GraphObserver* o : observers){
+            o->edgeChanged(x, y, c, std::numeric_limits<double>::infinity());
+        }
     }
 }
 
@@ -126,6 +332,10 @@ std::map<int, Edge> Graph::getEdges(int x){
     return adjList[x].edges;
 }
 
+EdgeRange Graph::edges(int x) const{
+    return EdgeRange(adjList[x].edges);
+}
+
 double Graph::getEdgeCost(int x, int y){
     
     if (adjList[x].edges.count(y)){
@@ -137,8 +347,12 @@ double Graph::getEdgeCost(int x, int y){
 void Graph::setEdgeCost(int x, int y, double c){
 
     if (adjList[x].edges.count(y)){
+        double old = adjList[x].edges[y].cost;
         adjList[x].edges[y].cost = c;
         adjList[y].edges[x].cost = c;
+        for (GraphObserver* o : observers){
+            o->edgeChanged(x, y, old, c);
+        }
     }
  
 }
@@ -185,200 +399,2450 @@ void Graph::printAdjMatrix(){
 }
 
 // ===================================================================== 
-// NodeInfo class to use with priority_queue in Shortestpath
+// Views over a CSRGraph: CSREdgeRange zips the target and cost arrays 
+// of one node into Edge values, CSRNeighborRange is a plain pointer 
+// span over its targets.
 // ===================================================================== 
 
-class NodeInfo{
+class CSREdgeRange{
     public:
-        int from;
-        int to;
-        double dist;
-        bool operator<(const NodeInfo& n) const{ // so can use it with priority_queue
-            return !(this->dist < n.dist);
-        }
+        class iterator{
+            public:
+                iterator(const int* t, const double* c) : t(t), c(c) {}
+                Edge operator*() const { Edge e = {*t, *c}; return e; }
+                iterator& operator++() { ++t; ++c; return *this; }
+                bool operator==(const iterator& o) const { return t == o.t; }
+                bool operator!=(const iterator& o) const { return t != o.t; }
+            private:
+                const int* t;
+                const double* c;
+        };
+        CSREdgeRange(const int* t, const double* c, int n) : t(t), c(c), n(n) {}
+        iterator begin() const { return iterator(t, c); }
+        iterator end() const { return iterator(t + n, c + n); }
+        int size() const { return n; }
+        
+    private:
+        const int* t;
+        const double* c;
+        int n;
+};
+
+class CSRNeighborRange{
+    public:
+        CSRNeighborRange(const int* t, int n) : t(t), n(n) {}
+        const int* begin() const { return t; }
+        const int* end() const { return t + n; }
+        int size() const { return n; }
+        
+    private:
+        const int* t;
+        int n;
 };
 
 // ===================================================================== 
-// ShortestPath Class (using Dijkstra)
+// CSRGraph Class: frozen, immutable compressed-sparse-row copy of a
+// Graph. The edges of node x are stored contiguously in targets/costs
+// between offsets[x] and offsets[x+1], so walking the neighbors is a 
+// linear scan instead of a red-black tree traversal. Build it once 
+// the Graph mutation is done.
 // ===================================================================== 
 
-class ShortestPath{
-    public:
-        ShortestPath();
-        ShortestPath(Graph *graph);
-        void addGraph(Graph *graph);
-        void runShortestPath(int source);
-        double avgPathLenght() const;
-        double avgPathDist() const;
-        std::list<int> path(int from, int to);
-        int pathSize(int from, int to);
-        double minDist(int from, int to);
+class CSRGraph{
+  
+  public:
+    CSRGraph();
+    CSRGraph(const Graph &graph); // freeze the current state of graph
+    CSRGraph(int numVertices, const std::vector<WeightedEdge> &edges); // build from an edge list, each edge once
+    int V() const; // returns the number of vertices in the graph
+    int E() const; // returns the number of edges in the graph
+    int degree(int x) const; // returns the number of edges leaving x
+    VertexRange getVertices() const; // return a view of the vertices in the graph
+    CSRNeighborRange neighbors(int x) const; // view of all nodes y such that there is an edge from x to y.
+    CSREdgeRange edges(int x) const; // view of the edges leaving x
+    int edgeBegin(int x) const; // index of the first edge of x
+    int edgeEnd(int x) const; // index one past the last edge of x
+    int target(int k) const; // returns the node reached by edge k
+    double cost(int k) const; // returns the cost of edge k
+    
+  private:
+    int numV; // number of Vertices
+    int numE; // number of Edges
+    std::vector<int> offsets; // numV + 1 offsets into targets/costs
+    std::vector<int> targets; // edge targets, grouped by source node
+    std::vector<double> costs; // edge costs, parallel to targets
     
-    private:
-        Graph* g;
-        int last_run;
-        std::map<int, std::list<int>> paths;
-        std::map<int, int> path_sizes;
-        std::map<int, double> min_distances;
-        double avg_path_length;
-        double avg_path_dist;
 };
 
-ShortestPath::ShortestPath() {}
+CSRGraph::CSRGraph()
+{
+  numV = 0;
+  numE = 0;
+  offsets.assign(1, 0);
+}
 
-ShortestPath::ShortestPath(Graph *graph){
-    g = graph;
+CSRGraph::CSRGraph(const Graph &graph)
+{
+  numV = graph.V();
+  numE = graph.E();
+  offsets.resize(numV + 1);
+  targets.resize(numE);
+  costs.resize(numE);
+  
+  int k = 0;
+  for(int i = 0; i < numV; ++i){
+      offsets[i] = k;
+      for (const Edge& e : graph.edges(i)){
+          targets[k] = e.to;
+          costs[k] = e.cost;
+          k++;
+      }
+  }
+  offsets[numV] = k;
 }
 
+// Counting sort of the edge list into the CSR arrays: one pass for the
+// degrees, one prefix sum and one pass to scatter both directions. An 
+// edge list from sortEdgeList leaves every row sorted by target.
+CSRGraph::CSRGraph(int numVertices, const std::vector<WeightedEdge> &edges)
+{
+  numV = numVertices;
+  numE = 2 * static_cast<int>(edges.size());
+  offsets.assign(numV + 1, 0);
+  targets.resize(numE);
+  costs.resize(numE);
+  
+  for (const WeightedEdge& we : edges){
+      offsets[we.from + 1]++;
+      offsets[we.to + 1]++;
+  }
+  for (int i = 0; i < numV; ++i){
+      offsets[i + 1] += offsets[i];
+  }
+  
+  std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+  for (const WeightedEdge& we : edges){
+      targets[cursor[we.from]] = we.to;
+      costs[cursor[we.from]++] = we.cost;
+      targets[cursor[we.to]] = we.from;
+      costs[cursor[we.to]++] = we.cost;
+  }
+}
 
-void ShortestPath::addGraph(Graph *graph){
-    g = graph;
+int CSRGraph::V() const{
+    return numV;
 }
 
+int CSRGraph::E() const{
+    return numE;
+}
 
-double ShortestPath::avgPathLenght() const {
-    return avg_path_length;
+int CSRGraph::degree(int x) const{
+    return offsets[x + 1] - offsets[x];
 }
 
+VertexRange CSRGraph::getVertices() const{
+    return VertexRange(numV);
+}
 
-double ShortestPath::avgPathDist() const {
-    return avg_path_dist;
+CSRNeighborRange CSRGraph::neighbors(int x) const{
+    return CSRNeighborRange(targets.data() + offsets[x], degree(x));
 }
 
+CSREdgeRange CSRGraph::edges(int x) const{
+    return CSREdgeRange(targets.data() + offsets[x], costs.data() + offsets[x], degree(x));
+}
 
-std::list<int> ShortestPath::path(int from, int to){
-    
-    if (from != last_run){
-        runShortestPath(from);
-    }
+int CSRGraph::edgeBegin(int x) const{
+    return offsets[x];
+}
+
+int CSRGraph::edgeEnd(int x) const{
+    return offsets[x + 1];
+}
+
+int CSRGraph::target(int k) const{
+    return targets[k];
+}
+
+double CSRGraph::cost(int k) const{
+    return costs[k];
+}
+
+// ===================================================================== 
+// EdgeListBuilder Class: buffers undirected edges without touching any
+// adjacency, then sorts and deduplicates them in a single pass and lays
+// them out either as a Graph or directly as a CSRGraph. 
+// ===================================================================== 
+
+class EdgeListBuilder{
+  
+  public:
+    EdgeListBuilder();
+    EdgeListBuilder(int numVertices);
+    void reserve(size_t numEdges); // reserve room for numEdges edges
+    void addEdge(int x, int y, double c); // buffers the edge (x,y), no lookup is done
+    void addEdges(const std::vector<WeightedEdge> &edges); // buffers a whole edge list
+    int readEdges(std::istream &in); // buffers "x y cost" triples up to the end of in
+    const std::vector<WeightedEdge>& finalize(); // sorts and deduplicates the buffered edges
+    Graph buildGraph(); // map based Graph, appended in order
+    CSRGraph buildCSR(); // CSR layout, one allocation per array
+    int V() const; // returns the number of vertices seen so far
     
-    if (paths.count(to)){
-        return paths[to];
-    }
+  private:
+    void grow(int x, int y);
+    int numV; // number of Vertices
+    bool sorted; // whether edges went through sortEdgeList
+    std::vector<WeightedEdge> edges; // buffered edges
     
-    std::list<int> el;
-    return el;
+};
+
+EdgeListBuilder::EdgeListBuilder()
+{
+  numV = 0;
+  sorted = true;
 }
 
+EdgeListBuilder::EdgeListBuilder(int numVertices)
+{
+  numV = numVertices;
+  sorted = true;
+}
 
-int ShortestPath::pathSize(int from, int to){
-    
-    if (from != last_run){
-        runShortestPath(from);
+void EdgeListBuilder::reserve(size_t numEdges){
+    edges.reserve(numEdges);
+}
+
+void EdgeListBuilder::grow(int x, int y){
+    numV = std::max(numV, std::max(x, y) + 1);
+}
+
+void EdgeListBuilder::addEdge(int x, int y, double c){
+    WeightedEdge we = {x, y, c};
+    edges.push_back(we);
+    grow(x, y);
+    sorted = false;
+}
+
+void EdgeListBuilder::addEdges(const std::vector<WeightedEdge> &list){
+    edges.insert(edges.end(), list.begin(), list.end());
+    for (const WeightedEdge& we : list){
+        grow(we.from, we.to);
     }
+    sorted = false;
+}
+
+int EdgeListBuilder::readEdges(std::istream &in){
     
-    if (path_sizes.count(to)) {
-        return path_sizes[to];    
+    size_t first = edges.size();
+    int count = readEdgeList(in, edges);
+    for (size_t k = first; k < edges.size(); ++k){
+        grow(edges[k].from, edges[k].to);
     }
-    
-    return INT_MAX;       
+    sorted = false;
+    return count;
+}
+
+const std::vector<WeightedEdge>& EdgeListBuilder::finalize(){
+    if (!sorted){
+        sortEdgeList(edges);
+        sorted = true;
+    }
+    return edges;
 }
 
+Graph EdgeListBuilder::buildGraph(){
+    return Graph(numV, finalize());
+}
 
-double ShortestPath::minDist(int from, int to){
+CSRGraph EdgeListBuilder::buildCSR(){
+    return CSRGraph(numV, finalize());
+}
+
+int EdgeListBuilder::V() const{
+    return numV;
+}
+
+// ===================================================================== 
+// IndexedHeap class: d-ary min-heap of vertex ids keyed by a double,
+// used as priority queue in ShortestPath and Prim. Every id is queued 
+// at most once and its key can be lowered in place (decrease-key), so
+// the queue holds O(V) entries instead of one per relaxed edge. The 
+// arity D trades a shallower tree against more comparisons per level.
+// ===================================================================== 
+
+template <int D>
+class IndexedHeap{
+    static_assert(D >= 2, "IndexedHeap arity must be at least 2");
     
-    if (from != last_run){
-        runShortestPath(from);
-    }
+    public:
+        IndexedHeap(int capacity = 0);
+        void reset(int capacity); // empty the heap and accept ids in [0, capacity)
+        void clear(); // empty the heap in O(size), keeping the capacity
+        bool empty() const;
+        int size() const;
+        bool contains(int id) const; // tests whether id is currently queued
+        double key(int id) const; // returns the key of a queued id
+        int top() const; // returns the id with the smallest key
+        double topKey() const; // returns the smallest key
+        void push(int id, double key); // inserts id, or lowers its key if already queued
+        int pop(); // removes and returns the id with the smallest key
     
-    if (min_distances.count(to)){
-        return min_distances[to];
+    private:
+        void siftUp(int i);
+        void siftDown(int i);
+        std::vector<int> heap; // queued ids in heap order
+        std::vector<int> pos; // position of each id in heap, -1 if not queued
+        std::vector<double> keys; // key of each id
+};
+
+// Arity used by ShortestPath and Prim
+typedef IndexedHeap<4> VertexQueue;
+
+template <int D>
+IndexedHeap<D>::IndexedHeap(int capacity){
+    reset(capacity);
+}
+
+template <int D>
+void IndexedHeap<D>::reset(int capacity){
+    heap.clear();
+    pos.assign(capacity, -1);
+    keys.assign(capacity, 0.0);
+}
+
+template <int D>
+void IndexedHeap<D>::clear(){
+    for (int id : heap){
+        pos[id] = -1;
     }
-    
-    return static_cast<double>(INT_MAX);
+    heap.clear();
 }
 
+template <int D>
+bool IndexedHeap<D>::empty() const{
+    return heap.empty();
+}
 
-void ShortestPath::runShortestPath(int source){
-    
-    last_run = source;
-    paths.clear();
-    path_sizes.clear();
-    min_distances.clear();
-    avg_path_length = 0.0;
-    avg_path_dist = 0.0;
+template <int D>
+int IndexedHeap<D>::size() const{
+    return static_cast<int>(heap.size());
+}
+
+template <int D>
+bool IndexedHeap<D>::contains(int id) const{
+    return pos[id] != -1;
+}
+
+template <int D>
+double IndexedHeap<D>::key(int id) const{
+    return keys[id];
+}
+
+template <int D>
+int IndexedHeap<D>::top() const{
+    return heap[0];
+}
+
+template <int D>
+double IndexedHeap<D>::topKey() const{
+    return keys[heap[0]];
+}
+
+template <int D>
+void IndexedHeap<D>::push(int id, double key){
     
-    std::priority_queue<NodeInfo> pq;
-    std::set<int> closed;
-    std::map<int, std::pair<int, double>> pathCost;
+    if (pos[id] == -1){
+        keys[id] = key;
+        pos[id] = static_cast<int>(heap.size());
+        heap.push_back(id);
+        siftUp(pos[id]);
+    } else if (key < keys[id]){
+        keys[id] = key;
+        siftUp(pos[id]);
+    }
+}
+
+template <int D>
+int IndexedHeap<D>::pop(){
     
-    int curr = source;
-    pathCost[curr] = std::make_pair(curr, 0.0);
-    auto edges = (*g).getEdges(curr);
-    for(auto it = edges.begin(); it != edges.end(); ++it){
-        NodeInfo n = {curr, (it->second).to, (it->second).cost + pathCost[curr].second};
-        pq.push(n);
+    int id = heap[0];
+    int last = heap.back();
+    heap.pop_back();
+    pos[id] = -1;
+    if (!heap.empty()){
+        heap[0] = last;
+        pos[last] = 0;
+        siftDown(0);
     }
-    closed.insert(curr);
+    return id;
+}
+
+template <int D>
+void IndexedHeap<D>::siftUp(int i){
     
-    while (!pq.empty()){
-        
-        NodeInfo top = pq.top();
-        pq.pop();
-        if (!pathCost.count(top.to) || (top.dist < pathCost[top.to].second)){
-            pathCost[top.to] = std::make_pair(top.from, top.dist);
-        }
-        
-        curr = top.to;
-        edges = (*g).getEdges(curr);
-        for(auto it = edges.begin(); it != edges.end(); ++it){
-            if (!closed.count((it->second).to)){
-                NodeInfo n = {curr, (it->second).to, (it->second).cost + pathCost[curr].second};
-                pq.push(n);
-            }
-        }
-        closed.insert(curr);
-        
+    int id = heap[i];
+    double k = keys[id];
+    while (i > 0){
+        int parent = (i - 1) / D;
+        if (!(k < keys[heap[parent]])) break;
+        heap[i] = heap[parent];
+        pos[heap[i]] = i;
+        i = parent;
     }
+    heap[i] = id;
+    pos[id] = i;
+}
+
+template <int D>
+void IndexedHeap<D>::siftDown(int i){
     
-    int cursor;
-    int path_counter = 0;
-    for (auto it = pathCost.begin(); it != pathCost.end(); ++it){
-                
-        cursor = it->first;
-        if(cursor == source) continue;
-        
-        double dist = (it->second).second;
-        
-        min_distances.insert({it->first, dist});
-        
-        std::list<int> path;
-        
-        path.push_front(cursor);
-        while ((pathCost[cursor].first) != source){
-            cursor = pathCost[cursor].first;
-            path.push_front(cursor);
-            path_counter++;
+    int n = static_cast<int>(heap.size());
+    int id = heap[i];
+    double k = keys[id];
+    while (true){
+        int first = D * i + 1;
+        if (first >= n) break;
+        int last = std::min(first + D, n);
+        int best = first;
+        for (int c = first + 1; c < last; ++c){
+            if (keys[heap[c]] < keys[heap[best]]) best = c;
         }
-        path.push_front(source);
-        paths.insert({it->first, path});
-        
-        path_sizes.insert({it->first, path.size()-1});
-        
-        avg_path_length += ((path.size()-1) - avg_path_length) / ++path_counter;
-        avg_path_dist += (dist - avg_path_dist) / path_counter;
-        
+        if (!(keys[heap[best]] < k)) break;
+        heap[i] = heap[best];
+        pos[heap[i]] = i;
+        i = best;
     }
-        
+    heap[i] = id;
+    pos[id] = i;
 }
 
 // ===================================================================== 
-// Montecarlo simulaiton
+// Integer queues: drop-in replacements for IndexedHeap (same push, pop,
+// empty, contains, key and topKey) when every key is a non-negative
+// integer, e.g. graphs with integer costs. They are picked at compile 
+// time, as in sp.runShortestPath<RadixHeap>(source). Neither supports
+// decrease-key in place: a push leaves the old entry behind and pop 
+// skips entries whose key is no longer the one of their id (lazy 
+// deletion). topKey moves to the smallest key, so it is not const.
+// 
+// RadixHeap: monotone, no key may be pushed below the last one popped,
+// which holds for Dijkstra but not for Prim. Keys go to the bucket of 
+// the highest bit where they differ from the last popped key, and each
+// entry moves down at most 64 times, so push is O(1) and pop O(log C)
+// amortized for keys up to C.
+// 
+// DialQueue: one bucket per key value, kept in a ring that only has to
+// span the queued keys (max cost + 1 buckets for Dijkstra) and doubles 
+// when it does not. Any key can be pushed: the cursor moves back when 
+// a key is lower than it, which serves Prim, whose keys are edge costs.
 // ===================================================================== 
 
-class Montecarlo{
+class RadixHeap{
+    
     public:
-        Montecarlo();
-        void run(int vertices, double density, double min_cost, double max_cost); 
+        RadixHeap(int capacity = 0);
+        void reset(int capacity); // empty the heap and accept ids in [0, capacity)
+        void clear();
+        bool empty() const;
+        int size() const;
+        bool contains(int id) const;
+        double key(int id) const;
+        double topKey(); // returns the smallest key
+        void push(int id, double key); // key must not be below the last popped key
+        int pop();
+    
+    private:
+        struct Entry{
+            int id;
+            unsigned long long key;
+        };
+        static int bucketOf(unsigned long long key, unsigned long long last);
+        void refill(); // brings the smallest key into bucket 0
+        std::vector<Entry> buckets[65];
+        std::vector<unsigned long long> keys; // key of each queued id
+        std::vector<char> queued;
+        unsigned long long last; // last popped key
+        int count;
 };
 
-Montecarlo::Montecarlo() {
-    srand(time(NULL));    
+RadixHeap::RadixHeap(int capacity){
+    reset(capacity);
 }
 
+void RadixHeap::reset(int capacity){
+    for (int b = 0; b < 65; ++b){
+        buckets[b].clear();
+    }
+    keys.assign(capacity, 0);
+    queued.assign(capacity, 0);
+    last = 0;
+    count = 0;
+}
 
-void Montecarlo::run(int vertices, double density, double min_cost, double max_cost){
-    
+void RadixHeap::clear(){
+    for (int b = 0; b < 65; ++b){
+        for (const Entry& e : buckets[b]){
+            queued[e.id] = 0;
+        }
+        buckets[b].clear();
+    }
+    last = 0;
+    count = 0;
+}
+
+bool RadixHeap::empty() const{
+    return count == 0;
+}
+
+int RadixHeap::size() const{
+    return count;
+}
+
+bool RadixHeap::contains(int id) const{
+    return queued[id] != 0;
+}
+
+double RadixHeap::key(int id) const{
+    return static_cast<double>(keys[id]);
+}
+
+double RadixHeap::topKey(){
+    refill();
+    return static_cast<double>(last);
+}
+
+int RadixHeap::bucketOf(unsigned long long key, unsigned long long last){
+    unsigned long long diff = key ^ last;
+#if defined(__GNUC__)
+    return (diff == 0) ? 0 : 64 - __builtin_clzll(diff);
+#else
+    int bit = 0;
+    while (diff != 0){
+        diff >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+void RadixHeap::push(int id, double key){
+    
+    unsigned long long k = static_cast<unsigned long long>(key);
+    if (queued[id]){
+        if (k >= keys[id]) return;
+    } else {
+        queued[id] = 1;
+        count++;
+    }
+    keys[id] = k;
+    Entry e = {id, k};
+    buckets[bucketOf(k, last)].push_back(e);
+}
+
+int RadixHeap::pop(){
+    
+    refill();
+    int id = buckets[0].back().id;
+    buckets[0].pop_back();
+    queued[id] = 0;
+    count--;
+    return id;
+}
+
+// Stale entries are dropped on the way; the heap must not be empty.
+void RadixHeap::refill(){
+    
+    while (true){
+        while (!buckets[0].empty()){
+            const Entry &e = buckets[0].back();
+            if (queued[e.id] && keys[e.id] == e.key) return;
+            buckets[0].pop_back();
+        }
+        int b = 1;
+        while (buckets[b].empty()){
+            b++;
+        }
+        unsigned long long lowest = ~0ULL;
+        for (const Entry& e : buckets[b]){
+            if (queued[e.id] && keys[e.id] == e.key) lowest = std::min(lowest, e.key);
+        }
+        if (lowest != ~0ULL){
+            last = lowest;
+            for (const Entry& e : buckets[b]){
+                if (queued[e.id] && keys[e.id] == e.key) buckets[bucketOf(e.key, last)].push_back(e);
+            }
+        }
+        buckets[b].clear();
+    }
+}
+
+class DialQueue{
+    
+    public:
+        DialQueue(int capacity = 0);
+        void reset(int capacity); // empty the queue and accept ids in [0, capacity)
+        void clear();
+        bool empty() const;
+        int size() const;
+        bool contains(int id) const;
+        double key(int id) const;
+        double topKey(); // returns the smallest key
+        void push(int id, double key); // inserts id, or lowers its key if already queued
+        int pop();
+    
+    private:
+        bool live(int id, unsigned long long key) const;
+        void grow(unsigned long long span); // makes the ring hold span consecutive keys
+        void advance(); // moves the cursor to the smallest key
+        std::vector<std::vector<int>> buckets; // ring of buckets, bucket of key k at k & mask
+        unsigned long long mask;
+        unsigned long long cursor; // no queued key is lower
+        unsigned long long highest; // no queued key is higher
+        std::vector<unsigned long long> keys;
+        std::vector<char> queued;
+        int count;
+};
+
+DialQueue::DialQueue(int capacity){
+    reset(capacity);
+}
+
+void DialQueue::reset(int capacity){
+    buckets.assign(64, std::vector<int>());
+    mask = 63;
+    cursor = highest = 0;
+    keys.assign(capacity, 0);
+    queued.assign(capacity, 0);
+    count = 0;
+}
+
+void DialQueue::clear(){
+    for (std::vector<int> &bucket : buckets){
+        for (int id : bucket){
+            queued[id] = 0;
+        }
+        bucket.clear();
+    }
+    cursor = highest = 0;
+    count = 0;
+}
+
+bool DialQueue::empty() const{
+    return count == 0;
+}
+
+int DialQueue::size() const{
+    return count;
+}
+
+bool DialQueue::contains(int id) const{
+    return queued[id] != 0;
+}
+
+double DialQueue::key(int id) const{
+    return static_cast<double>(keys[id]);
+}
+
+double DialQueue::topKey(){
+    advance();
+    return static_cast<double>(cursor);
+}
+
+bool DialQueue::live(int id, unsigned long long key) const{
+    return queued[id] && keys[id] == key;
+}
+
+void DialQueue::push(int id, double key){
+    
+    unsigned long long k = static_cast<unsigned long long>(key);
+    if (queued[id]){
+        if (k >= keys[id]) return;
+    } else {
+        queued[id] = 1;
+        count++;
+    }
+    if (count == 1){
+        cursor = highest = k;
+    }
+    unsigned long long low = std::min(cursor, k), high = std::max(highest, k);
+    if (high - low > mask){
+        grow(high - low + 1);
+    }
+    cursor = low;
+    highest = high;
+    keys[id] = k;
+    buckets[k & mask].push_back(id);
+}
+
+int DialQueue::pop(){
+    
+    advance();
+    std::vector<int> &bucket = buckets[cursor & mask];
+    int id = bucket.back();
+    bucket.pop_back();
+    queued[id] = 0;
+    count--;
+    return id;
+}
+
+// Drops stale entries of the cursor bucket and skips empty buckets; 
+// the queue must not be empty.
+void DialQueue::advance(){
+    
+    while (true){
+        // the ring spans the queued keys, so a live entry of this slot
+        // has the key of the cursor
+        std::vector<int> &bucket = buckets[cursor & mask];
+        while (!bucket.empty() && !live(bucket.back(), cursor)){
+            bucket.pop_back();
+        }
+        if (!bucket.empty()) return;
+        cursor++;
+    }
+}
+
+void DialQueue::grow(unsigned long long span){
+    
+    unsigned long long size = mask + 1;
+    while (size < span){
+        size *= 2;
+    }
+    std::vector<std::vector<int>> old(size);
+    old.swap(buckets);
+    mask = size - 1;
+    for (std::vector<int> &bucket : old){
+        for (int id : bucket){
+            if (queued[id]) buckets[keys[id] & mask].push_back(id);
+        }
+    }
+}
+
+// ===================================================================== 
+// ShortestPath Class (using Dijkstra)
+// In dynamic mode (Graph only, a CSRGraph cannot change) it subscribes
+// to the graph and repairs the results of the last run after each edit
+// instead of letting them go stale, in the style of Ramalingam and 
+// Reps: a cheaper or new edge starts a Dijkstra from its endpoints that
+// only touches the vertices that improve, while a dearer or removed 
+// tree edge resets the subtree hanging below it, seeds it from its 
+// unaffected neighbours and settles it again. Other edits cost O(1).
+// In bidirectional mode a query for a new source does not run a full
+// single source search: it searches from both ends at once (the graph
+// is undirected, so the reverse search uses the same edges) and stops
+// as soon as the two smallest queued keys add up to the best meeting
+// found, which only settles the vertices closer than about half of the
+// distance from either end. Only the touched vertices are reset.
+// runAStar answers one pair with A*: the heuristic is a template
+// parameter, called as heuristic(v, to), so it is inlined in the loop.
+// It must be consistent (never drop by more than an edge costs), e.g.
+// a LandmarkHeuristic, for the first path found to be the shortest.
+// runDeltaStepping is a parallel alternative to runShortestPath, see
+// its section below parallelFor.
+// ===================================================================== 
+
+enum class QueryMode {SINGLE_SOURCE, BIDIRECTIONAL};
+
+class ShortestPath : public GraphObserver{
+    public:
+        ShortestPath();
+        ShortestPath(Graph *graph);
+        ShortestPath(const CSRGraph *graph);
+        ShortestPath(const ShortestPath &other); // the copy is never dynamic
+        ShortestPath& operator=(const ShortestPath &other);
+        ~ShortestPath();
+        void addGraph(Graph *graph);
+        void addGraph(const CSRGraph *graph);
+        void setDynamic(bool enabled); // keep the last run up to date with the graph edits
+        bool isDynamic() const;
+        void setQueryMode(QueryMode queryMode); // how path, pathSize and minDist answer a new source
+        QueryMode queryMode() const;
+        void vertexAdded(int x);
+        void edgeChanged(int x, int y, double oldCost, double newCost);
+        void graphReplaced(); // forgets the last run
+        template <class Queue = VertexQueue>
+        void runShortestPath(int source); // Queue: VertexQueue, or RadixHeap or DialQueue for integer costs
+        void runDeltaStepping(int source, double delta = 0.0, int numThreads = 0); // delta <= 0 picks one from the costs
+        template <class Heuristic>
+        void runAStar(int from, int to, const Heuristic &heuristic); // path, pathSize and minDist of the pair then reuse it
+        int settledCount() const; // vertices settled by the last pair query
+        double avgPathLenght() const;
+        double avgPathDist() const;
+        std::list<int> path(int from, int to);
+        int pathSize(int from, int to);
+        double minDist(int from, int to);
+        const std::vector<double>& getDistances() const; // distances from the last source, infinity if unreachable
+        const std::vector<int>& getPredecessors() const; // predecessors on the last run, -1 if unreachable
+    
+    private:
+        template <class Queue, class GraphT>
+        void search(const GraphT &graph, int source);
+        bool reached(int to) const;
+        void summarize() const;
+        void relax(int from, int to, double cost);
+        void propagate();
+        bool answerPair(int from, int to); // runs the pair query if the mode calls for it
+        void preparePair(int n, int from, int to); // resets the scratch of the pair queries
+        template <class GraphT>
+        void searchPair(const GraphT &graph, int from, int to);
+        template <class GraphT>
+        void deltaStepping(const GraphT &graph, int source, double delta, int numThreads);
+        template <class GraphT>
+        void derivePredecessors(const GraphT &graph, int source, int numThreads);
+        template <class GraphT, class Heuristic>
+        void searchAStar(const GraphT &graph, int from, int to, const Heuristic &heuristic);
+        Graph* g;
+        const CSRGraph* csr;
+        bool dynamic; // subscribed to g
+        QueryMode mode;
+        int pair_from, pair_to; // last pair query, -1 if none
+        double pair_dist; // INT_MAX when there is no path
+        int pair_settled;
+        std::vector<int> pair_path;
+        std::vector<double> dist_fwd, dist_bwd; // scratch of the two searches
+        std::vector<int> pred_fwd, pred_bwd;
+        std::vector<int> touched; // vertices to reset before the next pair query
+        VertexQueue queue_fwd, queue_bwd;
+        int last_run;
+        std::vector<double> min_distances; // distance of every vertex from last_run
+        std::vector<int> predecessors; // previous vertex on the shortest path
+        std::vector<int> path_sizes; // number of edges on the shortest path
+        VertexQueue repair; // queue of the dynamic repairs
+        mutable bool stats_valid; // whether the averages match the arrays
+        mutable double avg_path_length;
+        mutable double avg_path_dist;
+};
+
+ShortestPath::ShortestPath() {
+    g = nullptr;
+    csr = nullptr;
+    dynamic = false;
+    mode = QueryMode::SINGLE_SOURCE;
+    pair_from = -1;
+    pair_settled = 0;
+    last_run = -1;
+    stats_valid = false;
+}
+
+ShortestPath::ShortestPath(Graph *graph){
+    g = graph;
+    csr = nullptr;
+    dynamic = false;
+    mode = QueryMode::SINGLE_SOURCE;
+    pair_from = -1;
+    pair_settled = 0;
+    last_run = -1;
+    stats_valid = false;
+}
+
+ShortestPath::ShortestPath(const CSRGraph *graph){
+    g = nullptr;
+    csr = graph;
+    dynamic = false;
+    mode = QueryMode::SINGLE_SOURCE;
+    pair_from = -1;
+    pair_settled = 0;
+    last_run = -1;
+    stats_valid = false;
+}
+
+ShortestPath::ShortestPath(const ShortestPath &other) : GraphObserver(other) {
+    g = nullptr;
+    csr = nullptr;
+    dynamic = false;
+    *this = other;
+}
+
+ShortestPath& ShortestPath::operator=(const ShortestPath &other){
+    setDynamic(false);
+    g = other.g;
+    csr = other.csr;
+    mode = other.mode;
+    pair_from = -1;
+    pair_settled = 0;
+    last_run = other.last_run;
+    min_distances = other.min_distances;
+    predecessors = other.predecessors;
+    path_sizes = other.path_sizes;
+    repair.reset(static_cast<int>(min_distances.size()));
+    stats_valid = other.stats_valid;
+    avg_path_length = other.avg_path_length;
+    avg_path_dist = other.avg_path_dist;
+    return *this;
+}
+
+ShortestPath::~ShortestPath(){
+    setDynamic(false);
+}
+
+
+void ShortestPath::addGraph(Graph *graph){
+    bool wasDynamic = dynamic;
+    setDynamic(false);
+    g = graph;
+    csr = nullptr;
+    last_run = -1;
+    pair_from = -1;
+    setDynamic(wasDynamic);
+}
+
+
+void ShortestPath::addGraph(const CSRGraph *graph){
+    setDynamic(false);
+    g = nullptr;
+    csr = graph;
+    last_run = -1;
+    pair_from = -1;
+}
+
+
+void ShortestPath::setDynamic(bool enabled){
+    
+    if (g == nullptr || enabled == dynamic){
+        return;
+    }
+    if (enabled){
+        g->subscribe(this);
+    } else {
+        g->unsubscribe(this);
+    }
+    dynamic = enabled;
+}
+
+
+bool ShortestPath::isDynamic() const {
+    return dynamic;
+}
+
+
+void ShortestPath::setQueryMode(QueryMode queryMode){
+    mode = queryMode;
+}
+
+
+QueryMode ShortestPath::queryMode() const {
+    return mode;
+}
+
+
+double ShortestPath::avgPathLenght() const {
+    summarize();
+    return avg_path_length;
+}
+
+
+double ShortestPath::avgPathDist() const {
+    summarize();
+    return avg_path_dist;
+}
+
+
+const std::vector<double>& ShortestPath::getDistances() const {
+    return min_distances;
+}
+
+
+const std::vector<int>& ShortestPath::getPredecessors() const {
+    return predecessors;
+}
+
+
+// The source itself is reported as having no path, as before.
+bool ShortestPath::reached(int to) const {
+    return to != last_run && predecessors[to] != -1;
+}
+
+
+// The path is rebuilt from the predecessor array on request.
+std::list<int> ShortestPath::path(int from, int to){
+    
+    if (answerPair(from, to)){
+        return std::list<int>(pair_path.begin(), pair_path.end());
+    }
+    if (from != last_run){
+        runShortestPath(from);
+    }
+    
+    std::list<int> el;
+    if (reached(to)){
+        for (int cursor = to; cursor != from; cursor = predecessors[cursor]){
+            el.push_front(cursor);
+        }
+        el.push_front(from);
+    }
+    
+    return el;
+}
+
+
+int ShortestPath::pathSize(int from, int to){
+    
+    if (answerPair(from, to)){
+        return pair_path.empty() ? INT_MAX : static_cast<int>(pair_path.size()) - 1;
+    }
+    if (from != last_run){
+        runShortestPath(from);
+    }
+    
+    if (reached(to)) {
+        return path_sizes[to];    
+    }
+    
+    return INT_MAX;       
+}
+
+
+double ShortestPath::minDist(int from, int to){
+    
+    if (answerPair(from, to)){
+        return pair_dist;
+    }
+    if (from != last_run){
+        runShortestPath(from);
+    }
+    
+    if (reached(to)){
+        return min_distances[to];
+    }
+    
+    return static_cast<double>(INT_MAX);
+}
+
+
+template <class Queue>
+void ShortestPath::runShortestPath(int source){
+    
+    last_run = source;
+    pair_from = -1;
+    stats_valid = false;
+    
+    if (csr != nullptr){
+        search<Queue>(*csr, source);
+    } else {
+        search<Queue>(*g, source);
+    }
+    repair.reset(static_cast<int>(min_distances.size()));
+}
+
+
+void ShortestPath::summarize() const {
+    
+    if (stats_valid){
+        return;
+    }
+    stats_valid = true;
+    avg_path_length = 0.0;
+    avg_path_dist = 0.0;
+    
+    int path_counter = 0;
+    for (int i = 0; i < static_cast<int>(predecessors.size()); ++i){
+        
+        if (!reached(i)) continue;
+        
+        path_counter++;
+        avg_path_length += (path_sizes[i] - avg_path_length) / path_counter;
+        avg_path_dist += (min_distances[i] - avg_path_dist) / path_counter;
+        
+    }
+        
+}
+
+
+// Dijkstra search over any graph exposing edges(x) as a range of Edge.
+template <class Queue, class GraphT>
+void ShortestPath::search(const GraphT &graph, int source){
+    
+    int n = graph.V();
+    min_distances.assign(n, std::numeric_limits<double>::infinity());
+    predecessors.assign(n, -1);
+    path_sizes.assign(n, 0);
+    
+    Queue pq(n);
+    std::vector<bool> closed(n, false);
+    
+    min_distances[source] = 0.0;
+    predecessors[source] = source;
+    pq.push(source, 0.0);
+    
+    while (!pq.empty()){
+        
+        int curr = pq.pop();
+        closed[curr] = true;
+        
+        double base = min_distances[curr];
+        for(const Edge& e : graph.edges(curr)){
+            if (closed[e.to]) continue;
+            double dist = base + e.cost;
+            if (dist < min_distances[e.to]){
+                min_distances[e.to] = dist;
+                predecessors[e.to] = curr;
+                path_sizes[e.to] = path_sizes[curr] + 1;
+                pq.push(e.to, dist);
+            }
+        }
+        
+    }
+}
+
+// The last pair query is reused, as is a full run from the same source;
+// otherwise a new pair query is run in bidirectional mode.
+bool ShortestPath::answerPair(int from, int to){
+    
+    if (pair_from != -1 && from == pair_from && to == pair_to){
+        return true;
+    }
+    if (mode != QueryMode::BIDIRECTIONAL || from == last_run){
+        return false;
+    }
+    if (csr != nullptr){
+        searchPair(*csr, from, to);
+    } else {
+        searchPair(*g, from, to);
+    }
+    return true;
+}
+
+
+// Bidirectional Dijkstra, each step expanding the side with the smaller
+// top key. best is the shortest from - to path seen through an edge
+// between the two searches; no path left can beat it once the two top 
+// keys add up to best. A later improvement of either end of that edge
+// also improves best, so the two predecessor chains stay valid.
+void ShortestPath::preparePair(int n, int from, int to){
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    if (static_cast<int>(dist_fwd.size()) != n){
+        dist_fwd.assign(n, inf);
+        dist_bwd.assign(n, inf);
+        pred_fwd.assign(n, -1);
+        pred_bwd.assign(n, -1);
+        queue_fwd.reset(n);
+        queue_bwd.reset(n);
+        touched.clear();
+    }
+    for (int v : touched){
+        dist_fwd[v] = dist_bwd[v] = inf;
+        pred_fwd[v] = pred_bwd[v] = -1;
+    }
+    touched.clear();
+    queue_fwd.clear();
+    queue_bwd.clear();
+    
+    pair_from = from;
+    pair_to = to;
+    pair_dist = static_cast<double>(INT_MAX);
+    pair_path.clear();
+    pair_settled = 0;
+}
+
+
+template <class GraphT>
+void ShortestPath::searchPair(const GraphT &graph, int from, int to){
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    preparePair(graph.V(), from, to);
+    if (from == to){
+        return;
+    }
+    
+    dist_fwd[from] = 0.0;
+    dist_bwd[to] = 0.0;
+    touched.push_back(from);
+    touched.push_back(to);
+    queue_fwd.push(from, 0.0);
+    queue_bwd.push(to, 0.0);
+    
+    double best = inf;
+    int meet_fwd = -1, meet_bwd = -1; // the edge joining the two searches
+    while (!queue_fwd.empty() && !queue_bwd.empty()){
+        
+        if (queue_fwd.topKey() + queue_bwd.topKey() >= best) break;
+        
+        bool forward = queue_fwd.topKey() <= queue_bwd.topKey();
+        VertexQueue &pq = forward ? queue_fwd : queue_bwd;
+        std::vector<double> &dist = forward ? dist_fwd : dist_bwd;
+        std::vector<double> &other = forward ? dist_bwd : dist_fwd;
+        std::vector<int> &pred = forward ? pred_fwd : pred_bwd;
+        
+        int curr = pq.pop();
+        pair_settled++;
+        double base = dist[curr];
+        for (const Edge& e : graph.edges(curr)){
+            double d = base + e.cost;
+            if (d < dist[e.to]){
+                if (dist_fwd[e.to] == inf && dist_bwd[e.to] == inf){
+                    touched.push_back(e.to);
+                }
+                dist[e.to] = d;
+                pred[e.to] = curr;
+                pq.push(e.to, d);
+            }
+            if (d + other[e.to] < best){
+                best = d + other[e.to];
+                meet_fwd = forward ? curr : e.to;
+                meet_bwd = forward ? e.to : curr;
+            }
+        }
+    }
+    
+    if (meet_fwd == -1){
+        return;
+    }
+    pair_dist = best;
+    for (int cursor = meet_fwd; cursor != -1; cursor = pred_fwd[cursor]){
+        pair_path.push_back(cursor);
+    }
+    std::reverse(pair_path.begin(), pair_path.end());
+    for (int cursor = meet_bwd; cursor != -1; cursor = pred_bwd[cursor]){
+        pair_path.push_back(cursor);
+    }
+}
+
+
+template <class Heuristic>
+void ShortestPath::runAStar(int from, int to, const Heuristic &heuristic){
+    
+    if (csr != nullptr){
+        searchAStar(*csr, from, to, heuristic);
+    } else {
+        searchAStar(*g, from, to, heuristic);
+    }
+}
+
+
+int ShortestPath::settledCount() const {
+    return pair_settled;
+}
+
+
+// Dijkstra from from keyed by distance plus heuristic, which settles
+// the vertices in the direction of to first and stops when to is
+// settled. It shares the scratch of the forward bidirectional search.
+template <class GraphT, class Heuristic>
+void ShortestPath::searchAStar(const GraphT &graph, int from, int to, const Heuristic &heuristic){
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    preparePair(graph.V(), from, to);
+    if (from == to){
+        return;
+    }
+    
+    dist_fwd[from] = 0.0;
+    touched.push_back(from);
+    queue_fwd.push(from, heuristic(from, to));
+    
+    while (!queue_fwd.empty()){
+        
+        int curr = queue_fwd.pop();
+        pair_settled++;
+        if (curr == to) break;
+        
+        double base = dist_fwd[curr];
+        for (const Edge& e : graph.edges(curr)){
+            double d = base + e.cost;
+            if (d < dist_fwd[e.to]){
+                if (dist_fwd[e.to] == inf){
+                    touched.push_back(e.to);
+                }
+                dist_fwd[e.to] = d;
+                pred_fwd[e.to] = curr;
+                queue_fwd.push(e.to, d + heuristic(e.to, to));
+            }
+        }
+    }
+    
+    if (dist_fwd[to] == inf){
+        return;
+    }
+    pair_dist = dist_fwd[to];
+    for (int cursor = to; cursor != -1; cursor = pred_fwd[cursor]){
+        pair_path.push_back(cursor);
+    }
+    std::reverse(pair_path.begin(), pair_path.end());
+}
+
+
+void ShortestPath::vertexAdded(int){
+    
+    pair_from = -1;
+    if (last_run == -1){
+        return;
+    }
+    min_distances.push_back(std::numeric_limits<double>::infinity());
+    predecessors.push_back(-1);
+    path_sizes.push_back(0);
+    repair.reset(static_cast<int>(min_distances.size()));
+}
+
+
+void ShortestPath::edgeChanged(int x, int y, double oldCost, double newCost){
+    
+    pair_from = -1;
+    if (last_run == -1 || newCost == oldCost){
+        return;
+    }
+    stats_valid = false;
+    
+    if (newCost < oldCost){
+        relax(x, y, newCost);
+        relax(y, x, newCost);
+        propagate();
+        return;
+    }
+    
+    // only a dearer tree edge can lengthen any path
+    int child = -1;
+    if (y != last_run && predecessors[y] == x){
+        child = y;
+    } else if (x != last_run && predecessors[x] == y){
+        child = x;
+    }
+    if (child == -1){
+        return;
+    }
+    
+    // the subtree below the edge, found through the predecessor links
+    std::vector<int> subtree(1, child);
+    for (size_t k = 0; k < subtree.size(); ++k){
+        for (int w : g->neighbors(subtree[k])){
+            if (w != last_run && predecessors[w] == subtree[k]){
+                subtree.push_back(w);
+            }
+        }
+    }
+    for (int v : subtree){
+        min_distances[v] = std::numeric_limits<double>::infinity();
+        predecessors[v] = -1;
+    }
+    
+    // reattach it to its best unaffected neighbours and settle it again
+    for (int v : subtree){
+        for (const Edge& e : g->edges(v)){
+            relax(e.to, v, e.cost);
+        }
+    }
+    propagate();
+}
+
+
+// Nothing of the old graph can be repaired, so the next query runs from
+// scratch, as after addGraph.
+void ShortestPath::graphReplaced(){
+    
+    pair_from = -1;
+    last_run = -1;
+    min_distances.clear();
+    predecessors.clear();
+    path_sizes.clear();
+    repair.reset(0);
+    stats_valid = false;
+}
+
+
+// Offers from -> to as a shorter path to to, queueing to if it improves.
+void ShortestPath::relax(int from, int to, double cost){
+    
+    double dist = min_distances[from] + cost;
+    if (dist < min_distances[to]){
+        min_distances[to] = dist;
+        predecessors[to] = from;
+        path_sizes[to] = path_sizes[from] + 1;
+        repair.push(to, dist);
+    }
+}
+
+
+// Dijkstra from the queued vertices, touching only what improves.
+void ShortestPath::propagate(){
+    
+    while (!repair.empty()){
+        int curr = repair.pop();
+        for (const Edge& e : g->edges(curr)){
+            relax(curr, e.to, e.cost);
+        }
+    }
+}
+
+// ===================================================================== 
+// LandmarkHeuristic class: ALT lower bounds for ShortestPath::runAStar.
+// A few landmarks are picked far apart (each one the farthest vertex 
+// from those already picked) and their distances to every vertex are
+// stored. By the triangle inequality |d(L,to) - d(L,v)| <= d(v,to) for
+// every landmark L, so the largest of these differences is a consistent
+// lower bound. Memory is one double per landmark and vertex.
+// ===================================================================== 
+
+class LandmarkHeuristic{
+    public:
+        LandmarkHeuristic();
+        LandmarkHeuristic(Graph *graph, int numLandmarks);
+        LandmarkHeuristic(const CSRGraph *graph, int numLandmarks);
+        double operator()(int v, int to) const; // lower bound of the distance from v to to
+        const std::vector<int>& getLandmarks() const;
+    
+    private:
+        void select(ShortestPath &sp, int n, int numLandmarks);
+        int numV;
+        std::vector<int> landmarks;
+        std::vector<double> distances; // distance of vertex v from landmark k at k * numV + v
+};
+
+LandmarkHeuristic::LandmarkHeuristic(){
+    numV = 0;
+}
+
+LandmarkHeuristic::LandmarkHeuristic(Graph *graph, int numLandmarks){
+    ShortestPath sp(graph);
+    select(sp, graph->V(), numLandmarks);
+}
+
+LandmarkHeuristic::LandmarkHeuristic(const CSRGraph *graph, int numLandmarks){
+    ShortestPath sp(graph);
+    select(sp, graph->V(), numLandmarks);
+}
+
+// Farthest point selection: vertex 0 only seeds the search and the
+// next landmark is always the reachable vertex farthest from the ones
+// chosen so far. A landmark cannot see other components, so once every
+// vertex of its own is close the next one starts an unseen component.
+void LandmarkHeuristic::select(ShortestPath &sp, int n, int numLandmarks){
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    numV = n;
+    landmarks.clear();
+    distances.clear();
+    if (n == 0) return;
+    
+    std::vector<double> nearest(n, inf); // distance to the closest landmark
+    sp.runShortestPath(0);
+    int next = 0;
+    for (int v = 0; v < n; ++v){
+        double d = sp.getDistances()[v];
+        if (d != inf && d > sp.getDistances()[next]) next = v;
+    }
+    
+    while (static_cast<int>(landmarks.size()) < std::min(numLandmarks, n)){
+        landmarks.push_back(next);
+        sp.runShortestPath(next);
+        const std::vector<double> &dist = sp.getDistances();
+        distances.insert(distances.end(), dist.begin(), dist.end());
+        
+        next = -1;
+        for (int v = 0; v < n; ++v){
+            nearest[v] = std::min(nearest[v], dist[v]);
+            // unreached vertices come first, then the farthest ones
+            if (next == -1 || nearest[v] > nearest[next]) next = v;
+        }
+        if (nearest[next] == 0.0) break;
+    }
+}
+
+double LandmarkHeuristic::operator()(int v, int to) const {
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    double bound = 0.0;
+    for (size_t k = 0; k < landmarks.size(); ++k){
+        const double *dist = &distances[k * numV];
+        if (dist[v] == inf || dist[to] == inf) continue;
+        double diff = std::fabs(dist[to] - dist[v]);
+        if (diff > bound) bound = diff;
+    }
+    return bound;
+}
+
+const std::vector<int>& LandmarkHeuristic::getLandmarks() const {
+    return landmarks;
+}
+
+// ===================================================================== 
+// ContractionHierarchy class: point-to-point queries on a static graph
+// after a preprocessing step (Geisberger et al.). Vertices are
+// contracted one at a time, the least important first by edge 
+// difference (shortcuts added minus edges removed) plus the number of
+// neighbours already contracted, with lazy updates of the order. When
+// v is contracted, a shortcut u - w is added for two neighbours only 
+// if a bounded witness search from u that avoids v finds no path as 
+// short as u - v - w. Every edge is then kept only at its lower ranked
+// end, and a query runs Dijkstra upward from both ends, meeting at the
+// highest vertex of the path. Each shortcut remembers the contracted 
+// middle vertex, so the path is unpacked recursively. The hierarchy 
+// can be saved and loaded back to skip the preprocessing.
+// ===================================================================== 
+
+struct CHArc{
+  int to;
+  int middle; // vertex the shortcut bypasses, -1 for an edge of the graph
+  double cost;
+};
+
+class ContractionHierarchy{
+    public:
+        ContractionHierarchy();
+        ContractionHierarchy(Graph *graph);
+        ContractionHierarchy(const CSRGraph *graph);
+        void build(Graph *graph);
+        void build(const CSRGraph *graph);
+        bool save(const std::string &path) const; // false if the file cannot be written
+        bool load(const std::string &path); // false, leaving the hierarchy as it was, on a bad file
+        std::list<int> path(int from, int to);
+        int pathSize(int from, int to);
+        double minDist(int from, int to);
+        int V() const;
+        int shortcuts() const; // number of shortcuts added by the preprocessing
+        
+        static const int WITNESS_SETTLE_LIMIT = 500; // vertices settled by a witness search at most
+    
+    private:
+        template <class GraphT>
+        void contractAll(const GraphT &graph);
+        int contract(int v, bool simulate); // returns the number of shortcuts needed
+        void witnessSearch(int source, int avoid, double limit);
+        const CHArc& findArc(int x, int y) const; // the arc between x and y, which must exist
+        void appendUnpacked(int from, int to, std::vector<int> &out) const;
+        void query(int from, int to);
+        int numV;
+        int numShortcuts;
+        std::vector<int> rank; // contraction order of each vertex
+        std::vector<int> upOffsets; // upward arcs of v at [upOffsets[v], upOffsets[v + 1])
+        std::vector<CHArc> upArcs; // arcs to higher ranked vertices
+        // preprocessing state
+        std::vector<std::map<int, CHArc>> remaining; // arcs among the uncontracted vertices
+        std::vector<int> contractedNeighbors;
+        std::vector<double> witness_dist;
+        std::vector<int> witness_touched;
+        VertexQueue witness_queue;
+        // query state
+        int query_from, query_to; // last query, -1 if none
+        double query_dist; // INT_MAX when there is no path
+        std::vector<int> query_path;
+        std::vector<double> dist_fwd, dist_bwd;
+        std::vector<int> pred_fwd, pred_bwd; // lower vertex of the arc reaching each vertex, -1 at the ends
+        std::vector<int> touched;
+        VertexQueue queue_fwd, queue_bwd;
+};
+
+const int ContractionHierarchy::WITNESS_SETTLE_LIMIT;
+
+struct CHFileHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int64_t numV;
+    int64_t numArcs;
+    int64_t numShortcuts;
+};
+
+const char CH_MAGIC[8] = {'C', 'H', 'G', 'R', 'A', 'P', 'H', '0'};
+const uint32_t CH_VERSION = 1;
+const uint32_t CH_BYTE_ORDER = 0x01020304;
+
+ContractionHierarchy::ContractionHierarchy(){
+    numV = 0;
+    numShortcuts = 0;
+    upOffsets.assign(1, 0);
+    query_from = -1;
+}
+
+ContractionHierarchy::ContractionHierarchy(Graph *graph){
+    build(graph);
+}
+
+ContractionHierarchy::ContractionHierarchy(const CSRGraph *graph){
+    build(graph);
+}
+
+void ContractionHierarchy::build(Graph *graph){
+    contractAll(*graph);
+}
+
+void ContractionHierarchy::build(const CSRGraph *graph){
+    contractAll(*graph);
+}
+
+int ContractionHierarchy::V() const {
+    return numV;
+}
+
+int ContractionHierarchy::shortcuts() const {
+    return numShortcuts;
+}
+
+template <class GraphT>
+void ContractionHierarchy::contractAll(const GraphT &graph){
+    
+    numV = graph.V();
+    numShortcuts = 0;
+    query_from = -1;
+    remaining.assign(numV, std::map<int, CHArc>());
+    for (int v = 0; v < numV; ++v){
+        for (const Edge& e : graph.edges(v)){
+            if (e.to == v) continue;
+            CHArc arc = {e.to, -1, e.cost};
+            remaining[v][e.to] = arc;
+        }
+    }
+    contractedNeighbors.assign(numV, 0);
+    witness_dist.assign(numV, std::numeric_limits<double>::infinity());
+    witness_touched.clear();
+    witness_queue.reset(numV);
+    rank.assign(numV, -1);
+    
+    VertexQueue order(numV);
+    for (int v = 0; v < numV; ++v){
+        order.push(v, contract(v, true) - static_cast<double>(remaining[v].size()));
+    }
+    
+    std::vector<std::vector<CHArc>> up(numV);
+    int next = 0;
+    while (!order.empty()){
+        
+        int v = order.pop();
+        // lazy update: the priority may have grown since it was queued
+        double priority = contract(v, true) - static_cast<double>(remaining[v].size()) + contractedNeighbors[v];
+        if (!order.empty() && priority > order.topKey()){
+            order.push(v, priority);
+            continue;
+        }
+        
+        numShortcuts += contract(v, false);
+        rank[v] = next++;
+        for (const auto& entry : remaining[v]){
+            up[v].push_back(entry.second);
+            remaining[entry.first].erase(v);
+            contractedNeighbors[entry.first]++;
+        }
+        std::map<int, CHArc>().swap(remaining[v]);
+    }
+    
+    upOffsets.assign(numV + 1, 0);
+    upArcs.clear();
+    for (int v = 0; v < numV; ++v){
+        upOffsets[v] = static_cast<int>(upArcs.size());
+        upArcs.insert(upArcs.end(), up[v].begin(), up[v].end());
+    }
+    upOffsets[numV] = static_cast<int>(upArcs.size());
+    
+    remaining.clear();
+    contractedNeighbors.clear();
+    witness_dist.clear();
+    witness_touched.clear();
+}
+
+// Every pair of remaining neighbours u, w of v needs the shortcut u - w
+// unless a witness search finds a path avoiding v that is no longer. 
+// Witness searches are bounded, so a few unneeded shortcuts may be 
+// added, which costs query time but never correctness.
+int ContractionHierarchy::contract(int v, bool simulate){
+    
+    std::vector<CHArc> neighbors;
+    neighbors.reserve(remaining[v].size());
+    for (const auto& entry : remaining[v]){
+        neighbors.push_back(entry.second);
+    }
+    
+    int needed = 0;
+    for (size_t i = 0; i + 1 < neighbors.size(); ++i){
+        
+        double limit = 0.0;
+        for (size_t j = i + 1; j < neighbors.size(); ++j){
+            limit = std::max(limit, neighbors[i].cost + neighbors[j].cost);
+        }
+        witnessSearch(neighbors[i].to, v, limit);
+        
+        for (size_t j = i + 1; j < neighbors.size(); ++j){
+            double via = neighbors[i].cost + neighbors[j].cost;
+            if (witness_dist[neighbors[j].to] <= via) continue;
+            needed++;
+            if (!simulate){
+                int u = neighbors[i].to, w = neighbors[j].to;
+                CHArc uw = {w, v, via}, wu = {u, v, via};
+                remaining[u][w] = uw;
+                remaining[w][u] = wu;
+            }
+        }
+    }
+    return needed;
+}
+
+// Dijkstra from source among the uncontracted vertices other than 
+// avoid, up to distance limit or WITNESS_SETTLE_LIMIT settled vertices.
+void ContractionHierarchy::witnessSearch(int source, int avoid, double limit){
+    
+    for (int v : witness_touched){
+        witness_dist[v] = std::numeric_limits<double>::infinity();
+    }
+    witness_touched.assign(1, source);
+    witness_queue.clear();
+    witness_dist[source] = 0.0;
+    witness_queue.push(source, 0.0);
+    
+    int settled = 0;
+    while (!witness_queue.empty() && settled < WITNESS_SETTLE_LIMIT){
+        
+        if (witness_queue.topKey() > limit) break;
+        int curr = witness_queue.pop();
+        settled++;
+        
+        double base = witness_dist[curr];
+        for (const auto& entry : remaining[curr]){
+            int to = entry.first;
+            if (to == avoid) continue;
+            double dist = base + entry.second.cost;
+            if (dist < witness_dist[to]){
+                if (witness_dist[to] == std::numeric_limits<double>::infinity()){
+                    witness_touched.push_back(to);
+                }
+                witness_dist[to] = dist;
+                witness_queue.push(to, dist);
+            }
+        }
+    }
+}
+
+bool ContractionHierarchy::save(const std::string &path) const {
+    
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    
+    CHFileHeader header;
+    std::copy(CH_MAGIC, CH_MAGIC + 8, header.magic);
+    header.version = CH_VERSION;
+    header.byteOrder = CH_BYTE_ORDER;
+    header.numV = numV;
+    header.numArcs = static_cast<int64_t>(upArcs.size());
+    header.numShortcuts = numShortcuts;
+    
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(rank.data()), sizeof(int) * numV);
+    out.write(reinterpret_cast<const char*>(upOffsets.data()), sizeof(int) * (numV + 1));
+    out.write(reinterpret_cast<const char*>(upArcs.data()), sizeof(CHArc) * upArcs.size());
+    
+    return static_cast<bool>(out);
+}
+
+bool ContractionHierarchy::load(const std::string &path){
+    
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in) return false;
+    
+    CHFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    if (!std::equal(CH_MAGIC, CH_MAGIC + 8, header.magic) || header.version != CH_VERSION ||
+        header.byteOrder != CH_BYTE_ORDER || header.numV < 0 || header.numArcs < 0 ||
+        header.numV >= INT_MAX || header.numArcs > INT_MAX){
+        return false;
+    }
+    
+    std::vector<int> newRank(header.numV), newOffsets(header.numV + 1);
+    std::vector<CHArc> newArcs(header.numArcs);
+    in.read(reinterpret_cast<char*>(newRank.data()), sizeof(int) * newRank.size());
+    in.read(reinterpret_cast<char*>(newOffsets.data()), sizeof(int) * newOffsets.size());
+    in.read(reinterpret_cast<char*>(newArcs.data()), sizeof(CHArc) * newArcs.size());
+    if (!in || newOffsets[0] != 0 || newOffsets[header.numV] != header.numArcs) return false;
+    
+    numV = static_cast<int>(header.numV);
+    numShortcuts = static_cast<int>(header.numShortcuts);
+    rank.swap(newRank);
+    upOffsets.swap(newOffsets);
+    upArcs.swap(newArcs);
+    query_from = -1;
+    return true;
+}
+
+// The path is unpacked from the arcs of the last query on request.
+std::list<int> ContractionHierarchy::path(int from, int to){
+    query(from, to);
+    return std::list<int>(query_path.begin(), query_path.end());
+}
+
+int ContractionHierarchy::pathSize(int from, int to){
+    query(from, to);
+    return query_path.empty() ? INT_MAX : static_cast<int>(query_path.size()) - 1;
+}
+
+double ContractionHierarchy::minDist(int from, int to){
+    query(from, to);
+    return query_dist;
+}
+
+// Upward bidirectional Dijkstra. Unlike a plain bidirectional search a 
+// side can only stop once its own top key reaches best, because the 
+// meeting vertex is the top of the path and not its middle.
+void ContractionHierarchy::query(int from, int to){
+    
+    if (from == query_from && to == query_to){
+        return;
+    }
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    if (static_cast<int>(dist_fwd.size()) != numV){
+        dist_fwd.assign(numV, inf);
+        dist_bwd.assign(numV, inf);
+        pred_fwd.assign(numV, -1);
+        pred_bwd.assign(numV, -1);
+        queue_fwd.reset(numV);
+        queue_bwd.reset(numV);
+        touched.clear();
+    }
+    for (int v : touched){
+        dist_fwd[v] = dist_bwd[v] = inf;
+        pred_fwd[v] = pred_bwd[v] = -1;
+    }
+    touched.clear();
+    queue_fwd.clear();
+    queue_bwd.clear();
+    
+    query_from = from;
+    query_to = to;
+    query_dist = static_cast<double>(INT_MAX);
+    query_path.clear();
+    if (from == to){
+        return;
+    }
+    
+    dist_fwd[from] = 0.0;
+    dist_bwd[to] = 0.0;
+    touched.push_back(from);
+    touched.push_back(to);
+    queue_fwd.push(from, 0.0);
+    queue_bwd.push(to, 0.0);
+    
+    double best = inf;
+    int meet = -1;
+    while (true){
+        
+        bool fwdOpen = !queue_fwd.empty() && queue_fwd.topKey() < best;
+        bool bwdOpen = !queue_bwd.empty() && queue_bwd.topKey() < best;
+        if (!fwdOpen && !bwdOpen) break;
+        
+        bool forward = fwdOpen && (!bwdOpen || queue_fwd.topKey() <= queue_bwd.topKey());
+        VertexQueue &pq = forward ? queue_fwd : queue_bwd;
+        std::vector<double> &dist = forward ? dist_fwd : dist_bwd;
+        std::vector<double> &other = forward ? dist_bwd : dist_fwd;
+        std::vector<int> &pred = forward ? pred_fwd : pred_bwd;
+        
+        int curr = pq.pop();
+        if (dist[curr] + other[curr] < best){
+            best = dist[curr] + other[curr];
+            meet = curr;
+        }
+        
+        double base = dist[curr];
+        for (int a = upOffsets[curr]; a < upOffsets[curr + 1]; ++a){
+            const CHArc &arc = upArcs[a];
+            double d = base + arc.cost;
+            if (d < dist[arc.to]){
+                if (dist_fwd[arc.to] == inf && dist_bwd[arc.to] == inf){
+                    touched.push_back(arc.to);
+                }
+                dist[arc.to] = d;
+                pred[arc.to] = curr;
+                pq.push(arc.to, d);
+            }
+        }
+    }
+    
+    if (meet == -1){
+        return;
+    }
+    query_dist = best;
+    
+    // up from from to the meeting vertex...
+    std::vector<int> chain;
+    for (int v = meet; v != -1; v = pred_fwd[v]){
+        chain.push_back(v);
+    }
+    std::reverse(chain.begin(), chain.end());
+    query_path.push_back(from);
+    for (size_t k = 1; k < chain.size(); ++k){
+        appendUnpacked(chain[k - 1], chain[k], query_path);
+    }
+    // ...and down to to
+    for (int v = meet; pred_bwd[v] != -1; v = pred_bwd[v]){
+        appendUnpacked(v, pred_bwd[v], query_path);
+    }
+}
+
+// Arcs are stored once, at their lower ranked end.
+const CHArc& ContractionHierarchy::findArc(int x, int y) const {
+    
+    int lower = (rank[x] < rank[y]) ? x : y;
+    int higher = x + y - lower;
+    int a = upOffsets[lower];
+    while (upArcs[a].to != higher){
+        ++a;
+    }
+    return upArcs[a];
+}
+
+// Appends the vertices of the arc from - to after from, replacing every
+// shortcut by its two halves until only graph edges are left.
+void ContractionHierarchy::appendUnpacked(int from, int to, std::vector<int> &out) const {
+    
+    std::vector<std::pair<int, int>> segments(1, std::make_pair(from, to)); // last one first
+    while (!segments.empty()){
+        std::pair<int, int> seg = segments.back();
+        segments.pop_back();
+        int middle = findArc(seg.first, seg.second).middle;
+        if (middle == -1){
+            out.push_back(seg.second);
+        } else {
+            segments.push_back(std::make_pair(middle, seg.second));
+            segments.push_back(std::make_pair(seg.first, middle));
+        }
+    }
+}
+
+// ===================================================================== 
+// parallelFor: runs body(i, thread) for every i in [0, count) on a 
+// small pool of threads that pull the next index from a shared atomic
+// counter, so uneven tasks still balance. thread is in [0, numThreads)
+// and lets the body keep per-thread scratch state. numThreads <= 0 
+// uses every hardware thread.
+// ===================================================================== 
+
+int defaultThreads(){
+    int n = static_cast<int>(std::thread::hardware_concurrency());
+    return (n > 0) ? n : 1;
+}
+
+template <class Body>
+void parallelFor(int count, int numThreads, Body body){
+    
+    if (numThreads <= 0) numThreads = defaultThreads();
+    numThreads = std::max(1, std::min(numThreads, count));
+    
+    std::atomic<int> next(0);
+    auto worker = [&](int thread){
+        for (int i = next++; i < count; i = next++){
+            body(i, thread);
+        }
+    };
+    
+    std::vector<std::thread> pool;
+    for (int t = 1; t < numThreads; ++t){
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& th : pool){
+        th.join();
+    }
+}
+
+// ===================================================================== 
+// ShortestPath: delta-stepping (Meyer and Sanders). Tentative distances
+// are kept in buckets of width delta and the lowest bucket is settled
+// in rounds: all its vertices relax their light edges (cost <= delta)
+// in parallel, which may refill the same bucket, until it stays empty;
+// then the heavy edges of every vertex it held are relaxed once. The 
+// relaxations are atomic compare-and-swap minimums and the improved
+// vertices go to per-thread lists that are bucketed between rounds. 
+// Costs must be positive. The distances are those of Dijkstra; the 
+// predecessors and path sizes are derived afterwards from them, which
+// gives the same tree unless several shortest paths tie.
+// ===================================================================== 
+
+void ShortestPath::runDeltaStepping(int source, double delta, int numThreads){
+    
+    last_run = source;
+    pair_from = -1;
+    stats_valid = false;
+    if (numThreads <= 0) numThreads = defaultThreads();
+    
+    if (csr != nullptr){
+        deltaStepping(*csr, source, delta, numThreads);
+        derivePredecessors(*csr, source, numThreads);
+    } else {
+        deltaStepping(*g, source, delta, numThreads);
+        derivePredecessors(*g, source, numThreads);
+    }
+    repair.reset(static_cast<int>(min_distances.size()));
+}
+
+
+template <class GraphT>
+void ShortestPath::deltaStepping(const GraphT &graph, int source, double delta, int numThreads){
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    const int CHUNK = 256; // vertices per parallelFor task
+    int n = graph.V();
+    int chunks = (n + CHUNK - 1) / CHUNK;
+    
+    // cost range of the graph, for the default delta and the buckets
+    std::vector<double> lowest(numThreads, inf), highest(numThreads, 0.0);
+    parallelFor(chunks, numThreads, [&](int c, int t){
+        for (int v = c * CHUNK; v < std::min(n, (c + 1) * CHUNK); ++v){
+            for (const Edge& e : graph.edges(v)){
+                lowest[t] = std::min(lowest[t], e.cost);
+                highest[t] = std::max(highest[t], e.cost);
+            }
+        }
+    });
+    double minCost = *std::min_element(lowest.begin(), lowest.end());
+    double maxCost = *std::max_element(highest.begin(), highest.end());
+    if (delta <= 0.0){
+        // about one light edge per vertex, like max_cost / average degree
+        double avgDegree = (n > 0) ? static_cast<double>(graph.E()) / n : 0.0;
+        delta = (avgDegree > 0.0) ? std::max(minCost, maxCost / avgDegree) : 1.0;
+    }
+    
+    std::vector<std::atomic<double>> dist(n);
+    parallelFor(chunks, numThreads, [&](int c, int){
+        for (int v = c * CHUNK; v < std::min(n, (c + 1) * CHUNK); ++v){
+            dist[v].store(inf, std::memory_order_relaxed);
+        }
+    });
+    
+    // a vertex is never queued more than maxCost / delta + 1 buckets 
+    // past the current one, so the buckets are reused cyclically
+    long long numBuckets = static_cast<long long>(maxCost / delta) + 2;
+    std::vector<std::vector<int>> buckets(numBuckets);
+    auto bucketOf = [&](int v){
+        return static_cast<long long>(dist[v].load(std::memory_order_relaxed) / delta);
+    };
+    
+    std::vector<std::vector<int>> improved(numThreads);
+    std::vector<int> frontier, settled;
+    auto relaxAll = [&](const std::vector<int> &from, bool light){
+        int tasks = (static_cast<int>(from.size()) + CHUNK - 1) / CHUNK;
+        parallelFor(tasks, numThreads, [&](int c, int t){
+            int end = std::min(static_cast<int>(from.size()), (c + 1) * CHUNK);
+            for (int k = c * CHUNK; k < end; ++k){
+                double base = dist[from[k]].load(std::memory_order_relaxed);
+                for (const Edge& e : graph.edges(from[k])){
+                    if ((e.cost <= delta) != light) continue;
+                    double d = base + e.cost;
+                    double old = dist[e.to].load(std::memory_order_relaxed);
+                    while (d < old && !dist[e.to].compare_exchange_weak(old, d, std::memory_order_relaxed)){}
+                    if (d < old) improved[t].push_back(e.to);
+                }
+            }
+        });
+        for (std::vector<int> &list : improved){
+            for (int w : list){
+                buckets[bucketOf(w) % numBuckets].push_back(w);
+            }
+            list.clear();
+        }
+    };
+    
+    std::vector<int> inFrontier(n, -1); // round that last took each vertex
+    std::vector<long long> inSettled(n, -1); // bucket that last took each vertex
+    int round = 0;
+    dist[source].store(0.0);
+    buckets[0].push_back(source);
+    
+    long long current = 0;
+    while (true){
+        
+        long long scanned = 0;
+        while (scanned < numBuckets && buckets[current % numBuckets].empty()){
+            current++;
+            scanned++;
+        }
+        if (scanned == numBuckets) break;
+        
+        settled.clear();
+        std::vector<int> &bucket = buckets[current % numBuckets];
+        while (!bucket.empty()){
+            round++;
+            frontier.clear();
+            for (int v : bucket){
+                // skip entries left behind by a later improvement
+                if (bucketOf(v) != current || inFrontier[v] == round) continue;
+                inFrontier[v] = round;
+                frontier.push_back(v);
+                if (inSettled[v] != current){
+                    inSettled[v] = current;
+                    settled.push_back(v);
+                }
+            }
+            bucket.clear();
+            relaxAll(frontier, true);
+        }
+        relaxAll(settled, false);
+        current++;
+    }
+    
+    min_distances.resize(n);
+    parallelFor(chunks, numThreads, [&](int c, int){
+        for (int v = c * CHUNK; v < std::min(n, (c + 1) * CHUNK); ++v){
+            min_distances[v] = dist[v].load(std::memory_order_relaxed);
+        }
+    });
+}
+
+
+// Every reached vertex takes the first neighbour that accounts exactly 
+// for its distance; the path sizes then follow in order of distance.
+template <class GraphT>
+void ShortestPath::derivePredecessors(const GraphT &graph, int source, int numThreads){
+    
+    const double inf = std::numeric_limits<double>::infinity();
+    int n = graph.V();
+    predecessors.assign(n, -1);
+    path_sizes.assign(n, 0);
+    
+    parallelFor(n, numThreads, [&](int v, int){
+        if (v == source || min_distances[v] == inf) return;
+        for (const Edge& e : graph.edges(v)){
+            if (min_distances[e.to] < min_distances[v] && min_distances[e.to] + e.cost == min_distances[v]){
+                predecessors[v] = e.to;
+                break;
+            }
+        }
+    });
+    predecessors[source] = source;
+    
+    std::vector<int> order;
+    order.reserve(n);
+    for (int v = 0; v < n; ++v){
+        if (predecessors[v] != -1 && v != source) order.push_back(v);
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b){ return min_distances[a] < min_distances[b]; });
+    for (int v : order){
+        path_sizes[v] = path_sizes[predecessors[v]] + 1;
+    }
+}
+
+// ===================================================================== 
+// AllPairsShortestPath Class: compact V x V distance matrix, filled 
+// either by one Dijkstra run per source spread over a thread pool 
+// (sources are independent), or by a cache-blocked Floyd-Warshall 
+// which is the better choice on dense graphs.
+// ===================================================================== 
+
+class AllPairsShortestPath{
+    public:
+        AllPairsShortestPath();
+        AllPairsShortestPath(Graph *graph);
+        AllPairsShortestPath(const CSRGraph *graph);
+        void addGraph(Graph *graph);
+        void addGraph(const CSRGraph *graph);
+        void runDijkstra(int numThreads = 0);
+        void runFloydWarshall(int blockSize = 64, int numThreads = 0);
+        double avgPathDist() const;
+        double minDist(int from, int to) const;
+        
+    private:
+        template <class GraphT>
+        void loadEdges(const GraphT &graph);
+        void relaxBlock(int ib, int jb, int kb, int blockSize);
+        void summarize();
+        Graph* g;
+        const CSRGraph* csr;
+        int numV;
+        std::vector<double> dist; // row-major numV x numV matrix
+        double avg_path_dist;
+};
+
+AllPairsShortestPath::AllPairsShortestPath(){
+    g = nullptr;
+    csr = nullptr;
+    numV = 0;
+    avg_path_dist = 0.0;
+}
+
+AllPairsShortestPath::AllPairsShortestPath(Graph *graph){
+    addGraph(graph);
+}
+
+AllPairsShortestPath::AllPairsShortestPath(const CSRGraph *graph){
+    addGraph(graph);
+}
+
+
+void AllPairsShortestPath::addGraph(Graph *graph){
+    g = graph;
+    csr = nullptr;
+    numV = graph->V();
+    dist.clear();
+    avg_path_dist = 0.0;
+}
+
+
+void AllPairsShortestPath::addGraph(const CSRGraph *graph){
+    g = nullptr;
+    csr = graph;
+    numV = graph->V();
+    dist.clear();
+    avg_path_dist = 0.0;
+}
+
+
+double AllPairsShortestPath::avgPathDist() const {
+    return avg_path_dist;
+}
+
+
+// Same conventions as ShortestPath::minDist: INT_MAX when there is no 
+// path, including from a vertex to itself.
+double AllPairsShortestPath::minDist(int from, int to) const {
+    
+    double d = dist[static_cast<size_t>(from) * numV + to];
+    if (from == to || d == std::numeric_limits<double>::infinity()){
+        return static_cast<double>(INT_MAX);
+    }
+    return d;
+}
+
+
+void AllPairsShortestPath::runDijkstra(int numThreads){
+    
+    if (numThreads <= 0) numThreads = defaultThreads();
+    dist.assign(static_cast<size_t>(numV) * numV, std::numeric_limits<double>::infinity());
+    
+    // one ShortestPath per thread, so its buffers are reused across sources
+    std::vector<ShortestPath> workers(numThreads);
+    for (auto& w : workers){
+        if (csr != nullptr){
+            w.addGraph(csr);
+        } else {
+            w.addGraph(g);
+        }
+    }
+    
+    parallelFor(numV, numThreads, [&](int source, int thread){
+        workers[thread].runShortestPath(source);
+        const std::vector<double>& row = workers[thread].getDistances();
+        std::copy(row.begin(), row.end(), dist.begin() + static_cast<size_t>(source) * numV);
+    });
+    
+    summarize();
+}
+
+
+void AllPairsShortestPath::runFloydWarshall(int blockSize, int numThreads){
+    
+    if (blockSize <= 0) blockSize = 64;
+    if (csr != nullptr){
+        loadEdges(*csr);
+    } else {
+        loadEdges(*g);
+    }
+    
+    int numBlocks = (numV + blockSize - 1) / blockSize;
+    for (int kb = 0; kb < numBlocks; ++kb){
+        
+        // the diagonal block first, then its row and column, then the rest
+        relaxBlock(kb, kb, kb, blockSize);
+        
+        parallelFor(numBlocks, numThreads, [&](int b, int){
+            if (b == kb) return;
+            relaxBlock(kb, b, kb, blockSize);
+            relaxBlock(b, kb, kb, blockSize);
+        });
+        
+        parallelFor(numBlocks, numThreads, [&](int ib, int){
+            if (ib == kb) return;
+            for (int jb = 0; jb < numBlocks; ++jb){
+                if (jb != kb) relaxBlock(ib, jb, kb, blockSize);
+            }
+        });
+    }
+    
+    summarize();
+}
+
+
+template <class GraphT>
+void AllPairsShortestPath::loadEdges(const GraphT &graph){
+    
+    dist.assign(static_cast<size_t>(numV) * numV, std::numeric_limits<double>::infinity());
+    for (int i = 0; i < numV; ++i){
+        dist[static_cast<size_t>(i) * numV + i] = 0.0;
+        for (const Edge& e : graph.edges(i)){
+            double& d = dist[static_cast<size_t>(i) * numV + e.to];
+            d = std::min(d, e.cost);
+        }
+    }
+}
+
+
+// Relaxes the tile (ib, jb) through the intermediate vertices of tile kb.
+void AllPairsShortestPath::relaxBlock(int ib, int jb, int kb, int blockSize){
+    
+    int iEnd = std::min(numV, (ib + 1) * blockSize);
+    int jBegin = jb * blockSize, jEnd = std::min(numV, (jb + 1) * blockSize);
+    int kEnd = std::min(numV, (kb + 1) * blockSize);
+    
+    for (int k = kb * blockSize; k < kEnd; ++k){
+        const double* rowK = &dist[static_cast<size_t>(k) * numV];
+        for (int i = ib * blockSize; i < iEnd; ++i){
+            double* rowI = &dist[static_cast<size_t>(i) * numV];
+            double dik = rowI[k];
+            if (dik == std::numeric_limits<double>::infinity()) continue;
+            for (int j = jBegin; j < jEnd; ++j){
+                double d = dik + rowK[j];
+                if (d < rowI[j]) rowI[j] = d;
+            }
+        }
+    }
+}
+
+
+void AllPairsShortestPath::summarize(){
+    
+    avg_path_dist = 0.0;
+    long long path_counter = 0;
+    for (int i = 0; i < numV; ++i){
+        for (int j = 0; j < numV; ++j){
+            double d = dist[static_cast<size_t>(i) * numV + j];
+            if (i == j || d == std::numeric_limits<double>::infinity()) continue;
+            path_counter++;
+            avg_path_dist += (d - avg_path_dist) / path_counter;
+        }
+    }
+}
+
+// ===================================================================== 
+// Montecarlo simulaiton
+// ===================================================================== 
+
+// Mean and variance of the per-graph shortest path statistics of a batch
+struct ExperimentStats{
+    int graphs;
+    double meanPathLength;
+    double varPathLength;
+    double meanPathDist;
+    double varPathDist;
+};
+
+class Montecarlo{
+    public:
+        Montecarlo();
+        Montecarlo(unsigned long long seed);
+        void run(int vertices, double density, double min_cost, double max_cost); 
+        ExperimentStats runBatch(int graphs, int vertices, double density, double min_cost, double max_cost, int numThreads = 0);
+        void sweep(const std::vector<int> &sizes, const std::vector<double> &densities, int graphs, double min_cost, double max_cost, int numThreads = 0);
+        static std::vector<WeightedEdge> randomEdges(int vertices, double density, double min_cost, double max_cost, std::mt19937_64 &rng);
+        static Graph randomGraph(int vertices, double density, double min_cost, double max_cost, std::mt19937_64 &rng);
+    
+    private:
+        unsigned long long seed; // base seed, every batch graph derives its own stream from it
+        unsigned long long batches; // number of batches run so far
+        std::mt19937_64 rng; // stream used by run()
+};
+
+Montecarlo::Montecarlo() {
+    seed = static_cast<unsigned long long>(time(NULL));
+    batches = 0;
+    rng.seed(seed);
+}
+
+Montecarlo::Montecarlo(unsigned long long seed) : seed(seed) {
+    batches = 0;
+    rng.seed(seed);
+}
+
+
+// G(n, p) generator by geometric skipping (Batagelj and Brandes): it 
+// is equivalent to running through all the possible undirected edges 
+// (i, j) and keeping each one with probability density, but it jumps 
+// directly to the next kept pair, so it costs O(V + E) instead of 
+// O(V^2). Costs are uniform in [min_cost, max_cost]. Edges come out as
+// (v, w) with w < v, ordered by v and then w.
+std::vector<WeightedEdge> Montecarlo::randomEdges(int vertices, double density, double min_cost, double max_cost, std::mt19937_64 &rng){
+    
+    std::vector<WeightedEdge> edges;
+    if (density <= 0.0 || vertices < 2){
+        return edges;
+    }
+    
+    double pairs = 0.5 * vertices * (vertices - 1.0);
+    edges.reserve(static_cast<size_t>(std::min(density, 1.0) * pairs * 1.05) + 16);
+    
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::uniform_real_distribution<double> costs(min_cost, max_cost);
+    double logq = std::log(1.0 - std::min(density, 1.0));
+    
+    long long v = 1, w = -1;
+    while (v < vertices){
+        double r = uniform(rng);
+        w += 1 + static_cast<long long>(std::floor(std::log(1.0 - r) / logq));
+        while (w >= v && v < vertices){
+            w -= v;
+            v++;
+        }
+        if (v < vertices){
+            WeightedEdge we = {static_cast<int>(v), static_cast<int>(w), costs(rng)};
+            edges.push_back(we);
+        }
+    }
+    
+    return edges;
+}
+
+
+Graph Montecarlo::randomGraph(int vertices, double density, double min_cost, double max_cost, std::mt19937_64 &rng){
+    return Graph(vertices, randomEdges(vertices, density, min_cost, max_cost, rng));
+}
+
+
+// Builds graphs random graphs in parallel and aggregates the average 
+// path length/distance from vertex 0 of each one. Graph k always draws
+// from its own mt19937_64 seeded with (seed, batch, k), so the result
+// does not depend on numThreads nor on scheduling.
+ExperimentStats Montecarlo::runBatch(int graphs, int vertices, double density, double min_cost, double max_cost, int numThreads){
+    
+    unsigned long long batch = batches++;
+    std::vector<double> lengths(graphs), dists(graphs);
+    
+    parallelFor(graphs, numThreads, [&](int k, int){
+        std::seed_seq sequence = {static_cast<unsigned>(seed), static_cast<unsigned>(seed >> 32), 
+                                  static_cast<unsigned>(batch), static_cast<unsigned>(k)};
+        std::mt19937_64 stream(sequence);
+        
+        CSRGraph frozen(vertices, randomEdges(vertices, density, min_cost, max_cost, stream));
+        ShortestPath DSP(&frozen);
+        DSP.runShortestPath(0);
+        lengths[k] = DSP.avgPathLenght();
+        dists[k] = DSP.avgPathDist();
+    });
+    
+    // Welford's update, in graph order so the sums are reproducible too
+    ExperimentStats stats = {0, 0.0, 0.0, 0.0, 0.0};
+    double m2Length = 0.0, m2Dist = 0.0;
+    for (int k = 0; k < graphs; ++k){
+        stats.graphs++;
+        double dl = lengths[k] - stats.meanPathLength;
+        stats.meanPathLength += dl / stats.graphs;
+        m2Length += dl * (lengths[k] - stats.meanPathLength);
+        double dd = dists[k] - stats.meanPathDist;
+        stats.meanPathDist += dd / stats.graphs;
+        m2Dist += dd * (dists[k] - stats.meanPathDist);
+    }
+    if (stats.graphs > 1){
+        stats.varPathLength = m2Length / (stats.graphs - 1);
+        stats.varPathDist = m2Dist / (stats.graphs - 1);
+    }
+    
+    return stats;
+}
+
+
+// Runs a batch for every (size, density) pair and prints one row each.
+void Montecarlo::sweep(const std::vector<int> &sizes, const std::vector<double> &densities, int graphs, double min_cost, double max_cost, int numThreads){
+    
+    std::cout << "Batch of " << graphs << " graphs per cell, seed " << seed << std::endl;
+    std::cout << std::setw(8) << "Vertices" << std::setw(9) << "Density";
+    std::cout << std::setw(12) << "Len mean" << std::setw(12) << "Len var";
+    std::cout << std::setw(12) << "Dist mean" << std::setw(12) << "Dist var" << std::endl;
+    
+    for (int vertices : sizes){
+        for (double density : densities){
+            ExperimentStats stats = runBatch(graphs, vertices, density, min_cost, max_cost, numThreads);
+            std::cout << std::setw(8) << vertices << std::setw(9) << std::setprecision(2) << density;
+            std::cout << std::setprecision(4);
+            std::cout << std::setw(12) << stats.meanPathLength << std::setw(12) << stats.varPathLength;
+            std::cout << std::setw(12) << stats.meanPathDist << std::setw(12) << stats.varPathDist << std::endl;
+        }
+    }
+}
+
+
+void Montecarlo::run(int vertices, double density, double min_cost, double max_cost){
+    
     for (int i = 0; i < vertices*5 + 2; ++i){
         std::cout << "=";
     }
@@ -387,18 +2851,7 @@ void Montecarlo::run(int vertices, double density, double min_cost, double max_c
     std::cout << "Running simulation..." << std::endl;
     std::cout << std::endl;
     
-    Graph G(vertices);
-    
-    double p, cost;
-    for(int i = 0; i < vertices-1; ++i){
-        for(int j = i + 1; j < vertices; ++j){
-            p = static_cast<double>(rand()) / RAND_MAX;
-            if (p <= density){
-                cost = (p/density) * (max_cost - min_cost) + min_cost;
-                G.addEdge(i, j, cost);
-            }   
-        }    
-    }
+    Graph G = randomGraph(vertices, density, min_cost, max_cost, rng);
     
     std::cout << "Vertices: " << vertices << std::endl;
     std::cout << "Density: " << std::setprecision(2) << density << std::endl;
@@ -409,11 +2862,16 @@ void Montecarlo::run(int vertices, double density, double min_cost, double max_c
     double actual_density = static_cast<double>(G.E()) / (G.V()*(G.V()-1));
     std::cout << "Achieved density: " << std::setw(5) << std::setprecision(4) << actual_density << std::endl;
     
-    ShortestPath DSP(&G);
+    CSRGraph frozen(G);
+    ShortestPath DSP(&frozen);
     DSP.runShortestPath(0);
     
     std::cout << "Average (Shortest Dijkstra)Path lenght: " << std::setprecision(2) << DSP.avgPathLenght() << std::endl;
     std::cout << "Average (Shortest Dijkstra)Path distance: " << std::setprecision(2) << DSP.avgPathDist() << std::endl;
+    
+    AllPairsShortestPath APSP(&frozen);
+    APSP.runDijkstra();
+    std::cout << "Average (All pairs)Path distance: " << std::setprecision(2) << APSP.avgPathDist() << std::endl;
     std::cout << std::endl;
     
     std::cout << "Adjacency Matrix" << std::endl;
@@ -455,5 +2913,9 @@ int main() {
     
     simulation.run(50, .4, 1.0, 10.);
     
+    std::cout << std::endl;
+    
+    simulation.sweep({50, 100}, {.2, .4}, 200, 1.0, 10.);
+    
     return 0;
 }
@@ -1,4 +1,5 @@
 // Prim Minimum spanning tree algorithm implementation
+// Build with: g++ -std=c++11 -O2 -pthread prim_minimum_spanning_tree.cpp
 
 #include <iostream>
 #include <iomanip>
@@ -9,9 +10,18 @@
 #include <set>
 #include <map>
 #include <list>
-#include <queue>
+#include <algorithm>
 #include <utility>
 #include <fstream>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 // ===================================================================== 
 // Definitions of the smallest components: Edge as a struct with a cost
@@ -29,6 +39,122 @@ struct Node{
     std::map<int, Edge> edges;
 };
 
+// An undirected edge as it comes out of a generator or an edge list
+struct WeightedEdge{
+  int from;
+  int to;
+  double cost;
+};
+
+// Orients every edge as from < to, drops self loops, then sorts the list
+// by (from, to) and keeps only the first copy of each edge, like repeated
+// Graph::addEdge calls would. The result feeds the bulk constructors of
+// Graph and CSRGraph in the order they append fastest.
+void sortEdgeList(std::vector<WeightedEdge> &edges){
+    
+    size_t kept = 0;
+    for (size_t k = 0; k < edges.size(); ++k){
+        WeightedEdge we = edges[k];
+        if (we.from == we.to) continue;
+        if (we.from > we.to) std::swap(we.from, we.to);
+        edges[kept++] = we;
+    }
+    edges.resize(kept);
+    
+    std::stable_sort(edges.begin(), edges.end(), [](const WeightedEdge& a, const WeightedEdge& b){
+        return (a.from < b.from) || (a.from == b.from && a.to < b.to);
+    });
+    
+    auto last = std::unique(edges.begin(), edges.end(), [](const WeightedEdge& a, const WeightedEdge& b){
+        return a.from == b.from && a.to == b.to;
+    });
+    edges.erase(last, edges.end());
+}
+
+// Reads "x y cost" triples until the end of the stream, returns how many.
+int readEdgeList(std::istream &in, std::vector<WeightedEdge> &edges){
+    
+    int count = 0;
+    WeightedEdge we;
+    while (in >> we.from >> we.to >> we.cost){
+        edges.push_back(we);
+        count++;
+    }
+    return count;
+}
+
+// ===================================================================== 
+// Read-only views used by Graph to hand out its vertices and edges
+// without copying them: EdgeRange walks the Edge values of a Node map
+// in place, NeighborRange walks their keys and VertexRange counts the 
+// dense vertex ids 0 .. V-1. A view is invalidated by any mutation of 
+// the Node it refers to.
+// =====================================================================
+
+class EdgeRange{
+    public:
+        class iterator{
+            public:
+                iterator(std::map<int, Edge>::const_iterator it) : it(it) {}
+                const Edge& operator*() const { return it->second; }
+                const Edge* operator->() const { return &(it->second); }
+                iterator& operator++() { ++it; return *this; }
+                bool operator==(const iterator& o) const { return it == o.it; }
+                bool operator!=(const iterator& o) const { return it != o.it; }
+            private:
+                std::map<int, Edge>::const_iterator it;
+        };
+        EdgeRange(const std::map<int, Edge> &edges) : edges(&edges) {}
+        iterator begin() const { return iterator(edges->begin()); }
+        iterator end() const { return iterator(edges->end()); }
+        int size() const { return static_cast<int>(edges->size()); }
+        
+    private:
+        const std::map<int, Edge>* edges;
+};
+
+class NeighborRange{
+    public:
+        class iterator{
+            public:
+                iterator(std::map<int, Edge>::const_iterator it) : it(it) {}
+                int operator*() const { return it->first; }
+                iterator& operator++() { ++it; return *this; }
+                bool operator==(const iterator& o) const { return it == o.it; }
+                bool operator!=(const iterator& o) const { return it != o.it; }
+            private:
+                std::map<int, Edge>::const_iterator it;
+        };
+        NeighborRange(const std::map<int, Edge> &edges) : edges(&edges) {}
+        iterator begin() const { return iterator(edges->begin()); }
+        iterator end() const { return iterator(edges->end()); }
+        int size() const { return static_cast<int>(edges->size()); }
+        
+    private:
+        const std::map<int, Edge>* edges;
+};
+
+class VertexRange{
+    public:
+        class iterator{
+            public:
+                iterator(int n) : n(n) {}
+                int operator*() const { return n; }
+                iterator& operator++() { ++n; return *this; }
+                bool operator==(const iterator& o) const { return n == o.n; }
+                bool operator!=(const iterator& o) const { return n != o.n; }
+            private:
+                int n;
+        };
+        VertexRange(int numVertices) : numV(numVertices) {}
+        iterator begin() const { return iterator(0); }
+        iterator end() const { return iterator(numV); }
+        int size() const { return numV; }
+        
+    private:
+        int numV;
+};
+
 // ===================================================================== 
 // Graph Class
 // ===================================================================== 
@@ -38,14 +164,16 @@ class Graph{
   public:
     Graph();
     Graph(int numVertices);
+    Graph(int numVertices, const std::vector<WeightedEdge> &edges); // bulk build from an edge list
     Graph(std::fstream &input_file);
     void addVertex(); // add an additional vertex to the graph.
-    std::vector<int> getVertices(); // return a vector of vertices in the graph
+    VertexRange getVertices() const; // return a view of the vertices in the graph
     bool adjacent(int x, int y); // tests whether there is an edge from node x to node y.
-    std::vector<int> neighbors(int x); // lists all nodes y such that there is an edge from x to y.
+    NeighborRange neighbors(int x) const; // view of all nodes y such that there is an edge from x to y.
     void addEdge(int x, int y, double c); // adds the edge from x to y, if it is not there.
     void removeEdge(int x, int y); // removes the edge from x to y, if it is there.
-    std::map<int, Edge> getEdges(int x);
+    std::map<int, Edge> getEdges(int x); // returns a copy of the edges of x, prefer edges(x).
+    EdgeRange edges(int x) const; // view of the edges leaving x, no copy is made.
     double getEdgeCost(int x, int y); // returns the value associated to the edge (x,y).
     void setEdgeCost(int x, int y, double c); // sets the value associated to the edge (x,y) to v.
     int V() const; // returns the number of vertices in the graph
@@ -78,22 +206,49 @@ Graph::Graph(int numVertices)
   }
 }
 
+// Every edge is appended with an end() hint, which is O(1) per edge 
+// when each node receives its neighbors in increasing order (e.g. the 
+// lists from sortEdgeList); any other order is still correct and 
+// duplicated edges are ignored like in addEdge.
+Graph::Graph(int numVertices, const std::vector<WeightedEdge> &edges)
+{
+  numV = 0;
+  numE = 0;
+  adjList.clear();
+  adjList.reserve(numVertices);
+  
+  for(int i = 0; i < numVertices; ++i){
+    addVertex();
+  }
+  
+  for (const WeightedEdge& we : edges){
+      std::map<int, Edge> &fromEdges = adjList[we.from].edges;
+      size_t before = fromEdges.size();
+      Edge xy = {we.to, we.cost}, yx = {we.from, we.cost};
+      fromEdges.emplace_hint(fromEdges.end(), we.to, xy);
+      if (fromEdges.size() != before){
+          adjList[we.to].edges.emplace_hint(adjList[we.to].edges.end(), we.from, yx);
+          numE+=2;
+      }
+  }
+}
+
+// The triples are loaded in bulk: read, sorted and deduplicated once 
+// and then appended, instead of one addEdge lookup per triple.
 Graph::Graph(std::fstream &input_file){
 
     numV = 0;
     numE = 0;
     adjList.clear();
 
-    int numVertices, x, y, cost;
+    int numVertices;
     input_file >> numVertices;
 
-    for (int i = 0; i < numVertices; ++i){
-        addVertex();
-    }
+    std::vector<WeightedEdge> edges;
+    readEdgeList(input_file, edges);
+    sortEdgeList(edges);
 
-    while (input_file >> x >> y >> cost){
-        addEdge(x, y, cost);
-    }
+    *this = Graph(numVertices, edges);
 }
 
 void Graph::addVertex(){
@@ -103,24 +258,16 @@ void Graph::addVertex(){
   numV++;
 }
 
-std::vector<int> Graph::getVertices(){
-    std::vector<int> vec;
-    for(auto it = adjList.begin(); it != adjList.end(); ++it){
-        vec.push_back((*it).n);
-    }
-    return vec;
+VertexRange Graph::getVertices() const{
+    return VertexRange(numV);
 }
 
 bool Graph::adjacent(int x, int y){
     return adjList[x].edges.count(y);
 }
 
-std::vector<int> Graph::neighbors(int x){
-    std::vector<int> vec;
-    for(auto it = adjList[x].edges.begin(); it != adjList[x].edges.end(); ++it){
-        vec.push_back(it->first);
-    }
-    return vec;
+NeighborRange Graph::neighbors(int x) const{
+    return NeighborRange(adjList[x].edges);
 }
 
 void Graph::addEdge(int x, int y, double c){
@@ -146,6 +293,10 @@ std::map<int, Edge> Graph::getEdges(int x){
     return adjList[x].edges;
 }
 
+EdgeRange Graph::edges(int x) const{
+    return EdgeRange(adjList[x].edges);
+}
+
 double Graph::getEdgeCost(int x, int y){
     
     if (adjList[x].edges.count(y)){
@@ -205,213 +356,1400 @@ void Graph::printAdjMatrix(){
 }
 
 // ===================================================================== 
-// NodeInfo class to use with priority_queue in Shortestpath
+// Views over a CSRGraph: CSREdgeRange zips the target and cost arrays 
+// of one node into Edge values, CSRNeighborRange is a plain pointer 
+// span over its targets.
 // ===================================================================== 
 
-class NodeInfo{
+class CSREdgeRange{
     public:
-        int from;
-        int to;
-        double dist;
-        bool operator<(const NodeInfo& n) const{ // so can use it with priority_queue
-            return !(this->dist < n.dist);
-        }
+        class iterator{
+            public:
+                iterator(const int* t, const double* c) : t(t), c(c) {}
+                Edge operator*() const { Edge e = {*t, *c}; return e; }
+                iterator& operator++() { ++t; ++c; return *this; }
+                bool operator==(const iterator& o) const { return t == o.t; }
+                bool operator!=(const iterator& o) const { return t != o.t; }
+            private:
+                const int* t;
+                const double* c;
+        };
+        CSREdgeRange(const int* t, const double* c, int n) : t(t), c(c), n(n) {}
+        iterator begin() const { return iterator(t, c); }
+        iterator end() const { return iterator(t + n, c + n); }
+        int size() const { return n; }
+        
+    private:
+        const int* t;
+        const double* c;
+        int n;
+};
+
+class CSRNeighborRange{
+    public:
+        CSRNeighborRange(const int* t, int n) : t(t), n(n) {}
+        const int* begin() const { return t; }
+        const int* end() const { return t + n; }
+        int size() const { return n; }
+        
+    private:
+        const int* t;
+        int n;
 };
 
 // ===================================================================== 
-// ShortestPath Class (using Dijkstra)
+// CSRGraph Class: frozen, immutable compressed-sparse-row copy of a
+// Graph. The edges of node x are stored contiguously in targets/costs
+// between offsets[x] and offsets[x+1], so walking the neighbors is a 
+// linear scan instead of a red-black tree traversal. Build it once 
+// the Graph mutation is done.
+// The arrays are either owned or, after openBinary, point straight into
+// a read-only mapping of a file written by writeBinary (see below).
 // ===================================================================== 
 
-class ShortestPath{
-    public:
-        ShortestPath();
-        ShortestPath(Graph *graph);
-        void addGraph(Graph *graph);
-        void runShortestPath(int source);
-        double avgPathLenght() const;
-        double avgPathDist() const;
-        std::list<int> path(int from, int to);
-        int pathSize(int from, int to);
-        double minDist(int from, int to);
+class CSRGraph{
+  
+  public:
+    CSRGraph();
+    CSRGraph(const Graph &graph); // freeze the current state of graph
+    CSRGraph(int numVertices, const std::vector<WeightedEdge> &edges); // build from an edge list, each edge once
+    CSRGraph(const CSRGraph &other);
+    CSRGraph& operator=(const CSRGraph &other);
+    bool writeBinary(const std::string &path) const; // save in the binary CSR format
+    bool openBinary(const std::string &path); // map a binary CSR file, false if it is not valid
+    int V() const; // returns the number of vertices in the graph
+    int E() const; // returns the number of edges in the graph
+    int degree(int x) const; // returns the number of edges leaving x
+    VertexRange getVertices() const; // return a view of the vertices in the graph
+    CSRNeighborRange neighbors(int x) const; // view of all nodes y such that there is an edge from x to y.
+    CSREdgeRange edges(int x) const; // view of the edges leaving x
+    int edgeBegin(int x) const; // index of the first edge of x
+    int edgeEnd(int x) const; // index one past the last edge of x
+    int target(int k) const; // returns the node reached by edge k
+    double cost(int k) const; // returns the cost of edge k
+    
+  private:
+    void bind();
+    int numV; // number of Vertices
+    int numE; // number of Edges
+    std::vector<int> offsets; // numV + 1 offsets into targets/costs
+    std::vector<int> targets; // edge targets, grouped by source node
+    std::vector<double> costs; // edge costs, parallel to targets
+    const int* offsetData; // offsets, owned or mapped
+    const int* targetData; // targets, owned or mapped
+    const double* costData; // costs, owned or mapped
+    std::shared_ptr<const char> mapping; // keeps the mapped file alive, null if owned
     
-    private:
-        Graph* g;
-        int last_run;
-        std::map<int, std::list<int>> paths;
-        std::map<int, int> path_sizes;
-        std::map<int, double> min_distances;
-        double avg_path_length;
-        double avg_path_dist;
 };
 
-ShortestPath::ShortestPath() {}
+CSRGraph::CSRGraph()
+{
+  numV = 0;
+  numE = 0;
+  offsets.assign(1, 0);
+  bind();
+}
 
-ShortestPath::ShortestPath(Graph *graph){
-    g = graph;
+CSRGraph::CSRGraph(const CSRGraph &other)
+{
+  *this = other;
 }
 
+CSRGraph& CSRGraph::operator=(const CSRGraph &other)
+{
+  numV = other.numV;
+  numE = other.numE;
+  offsets = other.offsets;
+  targets = other.targets;
+  costs = other.costs;
+  mapping = other.mapping;
+  offsetData = other.offsetData;
+  targetData = other.targetData;
+  costData = other.costData;
+  if (mapping == nullptr){
+      bind();
+  }
+  return *this;
+}
 
-void ShortestPath::addGraph(Graph *graph){
-    g = graph;
+// Points the accessors at the owned arrays.
+void CSRGraph::bind(){
+    offsetData = offsets.data();
+    targetData = targets.data();
+    costData = costs.data();
+}
+
+CSRGraph::CSRGraph(const Graph &graph)
+{
+  numV = graph.V();
+  numE = graph.E();
+  offsets.resize(numV + 1);
+  targets.resize(numE);
+  costs.resize(numE);
+  
+  int k = 0;
+  for(int i = 0; i < numV; ++i){
+      offsets[i] = k;
+      for (const Edge& e : graph.edges(i)){
+          targets[k] = e.to;
+          costs[k] = e.cost;
+          k++;
+      }
+  }
+  offsets[numV] = k;
+  bind();
 }
 
+// Counting sort of the edge list into the CSR arrays: one pass for the
+// degrees, one prefix sum and one pass to scatter both directions. An 
+// edge list from sortEdgeList leaves every row sorted by target.
+CSRGraph::CSRGraph(int numVertices, const std::vector<WeightedEdge> &edges)
+{
+  numV = numVertices;
+  numE = 2 * static_cast<int>(edges.size());
+  offsets.assign(numV + 1, 0);
+  targets.resize(numE);
+  costs.resize(numE);
+  
+  for (const WeightedEdge& we : edges){
+      offsets[we.from + 1]++;
+      offsets[we.to + 1]++;
+  }
+  for (int i = 0; i < numV; ++i){
+      offsets[i + 1] += offsets[i];
+  }
+  
+  std::vector<int> cursor(offsets.begin(), offsets.end() - 1);
+  for (const WeightedEdge& we : edges){
+      targets[cursor[we.from]] = we.to;
+      costs[cursor[we.from]++] = we.cost;
+      targets[cursor[we.to]] = we.from;
+      costs[cursor[we.to]++] = we.cost;
+  }
+  bind();
+}
 
-double ShortestPath::avgPathLenght() const {
-    return avg_path_length;
+int CSRGraph::V() const{
+    return numV;
 }
 
+int CSRGraph::E() const{
+    return numE;
+}
 
-double ShortestPath::avgPathDist() const {
-    return avg_path_dist;
+int CSRGraph::degree(int x) const{
+    return offsetData[x + 1] - offsetData[x];
 }
 
+VertexRange CSRGraph::getVertices() const{
+    return VertexRange(numV);
+}
 
-std::list<int> ShortestPath::path(int from, int to){
+CSRNeighborRange CSRGraph::neighbors(int x) const{
+    return CSRNeighborRange(targetData + offsetData[x], degree(x));
+}
+
+CSREdgeRange CSRGraph::edges(int x) const{
+    return CSREdgeRange(targetData + offsetData[x], costData + offsetData[x], degree(x));
+}
+
+int CSRGraph::edgeBegin(int x) const{
+    return offsetData[x];
+}
+
+int CSRGraph::edgeEnd(int x) const{
+    return offsetData[x + 1];
+}
+
+int CSRGraph::target(int k) const{
+    return targetData[k];
+}
+
+double CSRGraph::cost(int k) const{
+    return costData[k];
+}
+
+// ===================================================================== 
+// Binary CSR format, version 1, native byte order:
+//   header   magic "CSRGRAPH", uint32 version, uint32 byte order mark,
+//            int64 number of vertices, int64 number of edges
+//   int32    offsets[V + 1]
+//   int32    targets[E]
+//   padding  to a multiple of 8 bytes
+//   double   costs[E]
+// Every array starts at a fixed position computed from V and E, so 
+// openBinary only checks the header and the file size and then hands
+// out pointers into the mapping: the pages are read on first touch.
+// ===================================================================== 
+
+struct CSRFileHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    int64_t numV;
+    int64_t numE;
+};
+
+const char CSR_MAGIC[8] = {'C', 'S', 'R', 'G', 'R', 'A', 'P', 'H'};
+const uint32_t CSR_VERSION = 1;
+const uint32_t CSR_BYTE_ORDER = 0x01020304;
+
+// Byte offset of the costs array in a file with numV vertices and numE edges.
+size_t csrCostsOffset(int64_t numV, int64_t numE){
+    size_t end = sizeof(CSRFileHeader) + sizeof(int32_t) * static_cast<size_t>(numV + 1 + numE);
+    return (end + 7) / 8 * 8;
+}
+
+bool CSRGraph::writeBinary(const std::string &path) const{
     
-    if (from != last_run){
-        runShortestPath(from);
-    }
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) return false;
     
-    if (paths.count(to)){
-        return paths[to];
-    }
+    CSRFileHeader header;
+    std::copy(CSR_MAGIC, CSR_MAGIC + 8, header.magic);
+    header.version = CSR_VERSION;
+    header.byteOrder = CSR_BYTE_ORDER;
+    header.numV = numV;
+    header.numE = numE;
     
-    std::list<int> el;
-    return el;
+    size_t written = sizeof(CSRFileHeader) + sizeof(int32_t) * static_cast<size_t>(numV + 1 + numE);
+    const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(offsetData), sizeof(int32_t) * (numV + 1));
+    out.write(reinterpret_cast<const char*>(targetData), sizeof(int32_t) * numE);
+    out.write(padding, csrCostsOffset(numV, numE) - written);
+    out.write(reinterpret_cast<const char*>(costData), sizeof(double) * numE);
+    
+    return static_cast<bool>(out);
 }
 
-
-int ShortestPath::pathSize(int from, int to){
+bool CSRGraph::openBinary(const std::string &path){
     
-    if (from != last_run){
-        runShortestPath(from);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) return false;
+    
+    struct stat st;
+    if (fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) < sizeof(CSRFileHeader)){
+        close(fd);
+        return false;
     }
     
-    if (path_sizes.count(to)) {
-        return path_sizes[to];    
+    size_t length = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return false;
+    
+    std::shared_ptr<const char> file(static_cast<const char*>(mapped), [length](const char* p){
+        munmap(const_cast<char*>(p), length);
+    });
+    
+    const CSRFileHeader* header = reinterpret_cast<const CSRFileHeader*>(file.get());
+    if (!std::equal(CSR_MAGIC, CSR_MAGIC + 8, header->magic) || header->version != CSR_VERSION ||
+        header->byteOrder != CSR_BYTE_ORDER || header->numV < 0 || header->numE < 0 ||
+        header->numV >= INT_MAX || header->numE > INT_MAX){
+        return false;
+    }
+    if (length != csrCostsOffset(header->numV, header->numE) + sizeof(double) * header->numE){
+        return false;
+    }
+    // the offsets are not scanned, but their ends must frame the targets
+    const int32_t* fileOffsets = reinterpret_cast<const int32_t*>(file.get() + sizeof(CSRFileHeader));
+    if (fileOffsets[0] != 0 || fileOffsets[header->numV] != header->numE){
+        return false;
     }
     
-    return INT_MAX;       
+    numV = static_cast<int>(header->numV);
+    numE = static_cast<int>(header->numE);
+    offsets.clear();
+    targets.clear();
+    costs.clear();
+    offsets.shrink_to_fit();
+    targets.shrink_to_fit();
+    costs.shrink_to_fit();
+    
+    const char* base = file.get();
+    offsetData = reinterpret_cast<const int*>(base + sizeof(CSRFileHeader));
+    targetData = offsetData + numV + 1;
+    costData = reinterpret_cast<const double*>(base + csrCostsOffset(numV, numE));
+    mapping = file;
+    
+    return true;
 }
 
+// ===================================================================== 
+// EdgeListBuilder Class: buffers undirected edges without touching any
+// adjacency, then sorts and deduplicates them in a single pass and lays
+// them out either as a Graph or directly as a CSRGraph. 
+// ===================================================================== 
 
-double ShortestPath::minDist(int from, int to){
+class EdgeListBuilder{
+  
+  public:
+    EdgeListBuilder();
+    EdgeListBuilder(int numVertices);
+    void reserve(size_t numEdges); // reserve room for numEdges edges
+    void addEdge(int x, int y, double c); // buffers the edge (x,y), no lookup is done
+    void addEdges(const std::vector<WeightedEdge> &edges); // buffers a whole edge list
+    int readEdges(std::istream &in); // buffers "x y cost" triples up to the end of in
+    const std::vector<WeightedEdge>& finalize(); // sorts and deduplicates the buffered edges
+    Graph buildGraph(); // map based Graph, appended in order
+    CSRGraph buildCSR(); // CSR layout, one allocation per array
+    int V() const; // returns the number of vertices seen so far
     
-    if (from != last_run){
-        runShortestPath(from);
-    }
+  private:
+    void grow(int x, int y);
+    int numV; // number of Vertices
+    bool sorted; // whether edges went through sortEdgeList
+    std::vector<WeightedEdge> edges; // buffered edges
     
-    if (min_distances.count(to)){
-        return min_distances[to];
+};
+
+EdgeListBuilder::EdgeListBuilder()
+{
+  numV = 0;
+  sorted = true;
+}
+
+EdgeListBuilder::EdgeListBuilder(int numVertices)
+{
+  numV = numVertices;
+  sorted = true;
+}
+
+void EdgeListBuilder::reserve(size_t numEdges){
+    edges.reserve(numEdges);
+}
+
+void EdgeListBuilder::grow(int x, int y){
+    numV = std::max(numV, std::max(x, y) + 1);
+}
+
+void EdgeListBuilder::addEdge(int x, int y, double c){
+    WeightedEdge we = {x, y, c};
+    edges.push_back(we);
+    grow(x, y);
+    sorted = false;
+}
+
+void EdgeListBuilder::addEdges(const std::vector<WeightedEdge> &list){
+    edges.insert(edges.end(), list.begin(), list.end());
+    for (const WeightedEdge& we : list){
+        grow(we.from, we.to);
     }
+    sorted = false;
+}
+
+int EdgeListBuilder::readEdges(std::istream &in){
     
-    return static_cast<double>(INT_MAX);
+    size_t first = edges.size();
+    int count = readEdgeList(in, edges);
+    for (size_t k = first; k < edges.size(); ++k){
+        grow(edges[k].from, edges[k].to);
+    }
+    sorted = false;
+    return count;
 }
 
+const std::vector<WeightedEdge>& EdgeListBuilder::finalize(){
+    if (!sorted){
+        sortEdgeList(edges);
+        sorted = true;
+    }
+    return edges;
+}
 
-void ShortestPath::runShortestPath(int source){
-    
-    last_run = source;
-    paths.clear();
-    path_sizes.clear();
-    min_distances.clear();
-    avg_path_length = 0.0;
-    avg_path_dist = 0.0;
-    
-    std::priority_queue<NodeInfo> pq;
-    std::set<int> closed;
-    std::map<int, std::pair<int, double>> pathCost;
+Graph EdgeListBuilder::buildGraph(){
+    return Graph(numV, finalize());
+}
+
+CSRGraph EdgeListBuilder::buildCSR(){
+    return CSRGraph(numV, finalize());
+}
+
+int EdgeListBuilder::V() const{
+    return numV;
+}
+
+// ===================================================================== 
+// parallelFor: runs body(i, thread) for every i in [0, count) on a 
+// small pool of threads that pull the next index from a shared atomic
+// counter, so uneven tasks still balance. thread is in [0, numThreads)
+// and lets the body keep per-thread scratch state. numThreads <= 0 
+// uses every hardware thread.
+// ===================================================================== 
+
+int defaultThreads(){
+    int n = static_cast<int>(std::thread::hardware_concurrency());
+    return (n > 0) ? n : 1;
+}
+
+template <class Body>
+void parallelFor(int count, int numThreads, Body body){
     
-    int curr = source;
-    pathCost[curr] = std::make_pair(curr, 0.0);
-    auto edges = (*g).getEdges(curr);
-    for(auto it = edges.begin(); it != edges.end(); ++it){
-        NodeInfo n = {curr, (it->second).to, (it->second).cost + pathCost[curr].second};
-        pq.push(n);
-    }
-    closed.insert(curr);
+    if (numThreads <= 0) numThreads = defaultThreads();
+    numThreads = std::max(1, std::min(numThreads, count));
     
-    while (!pq.empty()){
-        
-        NodeInfo top = pq.top();
-        pq.pop();
-        if (!pathCost.count(top.to) || (top.dist < pathCost[top.to].second)){
-            pathCost[top.to] = std::make_pair(top.from, top.dist);
+    std::atomic<int> next(0);
+    auto worker = [&](int thread){
+        for (int i = next++; i < count; i = next++){
+            body(i, thread);
         }
-        
-        curr = top.to;
-        edges = (*g).getEdges(curr);
-        for(auto it = edges.begin(); it != edges.end(); ++it){
-            if (!closed.count((it->second).to)){
-                NodeInfo n = {curr, (it->second).to, (it->second).cost + pathCost[curr].second};
-                pq.push(n);
-            }
-        }
-        closed.insert(curr);
-        
-    }
+    };
     
-    int cursor;
-    int path_counter = 0;
-    for (auto it = pathCost.begin(); it != pathCost.end(); ++it){
-                
-        cursor = it->first;
-        if(cursor == source) continue;
-        
-        double dist = (it->second).second;
-        
-        min_distances.insert({it->first, dist});
-        
-        std::list<int> path;
-        
-        path.push_front(cursor);
-        while ((pathCost[cursor].first) != source){
-            cursor = pathCost[cursor].first;
-            path.push_front(cursor);
-            path_counter++;
-        }
-        path.push_front(source);
-        paths.insert({it->first, path});
-        
-        path_sizes.insert({it->first, path.size()-1});
-        
-        avg_path_length += ((path.size()-1) - avg_path_length) / ++path_counter;
-        avg_path_dist += (dist - avg_path_dist) / path_counter;
-        
+    std::vector<std::thread> pool;
+    for (int t = 1; t < numThreads; ++t){
+        pool.emplace_back(worker, t);
+    }
+    worker(0);
+    for (auto& th : pool){
+        th.join();
     }
-        
 }
 
 // ===================================================================== 
-// Montecarlo simulaiton
+// GraphFileLoader Class: reads the "N then i j cost triples" format of
+// sample_data through a read-only mmap of the whole file. Numbers are 
+// parsed by hand (no locale, no stream state) and costs keep their 
+// fractional part. The body is split into one chunk per thread at line
+// boundaries, so it expects one triple per line, and the chunks are 
+// parsed in parallel and concatenated in file order. The file is not 
+// trusted: a malformed token, an int that overflows or a vertex id out
+// of [0, V()) fails the whole load instead of dropping edges.
 // ===================================================================== 
 
-class Montecarlo{
-    public:
-        Montecarlo();
-        void run(int vertices, double density, double min_cost, double max_cost); 
+class GraphFileLoader{
+  
+  public:
+    GraphFileLoader(const std::string &path);
+    ~GraphFileLoader();
+    bool isOpen() const; // whether the file could be mapped and has a header
+    int V() const; // returns the number of vertices in the header
+    bool parse(std::vector<WeightedEdge> &edges, int numThreads = 0); // all triples, in file order, false if malformed
+    bool loadGraph(Graph &graph, int numThreads = 0); // false, graph untouched, if malformed
+    bool loadCSR(CSRGraph &graph, int numThreads = 0); // false, graph untouched, if malformed
+    
+  private:
+    GraphFileLoader(const GraphFileLoader&);
+    GraphFileLoader& operator=(const GraphFileLoader&);
+    static const char* skipSpace(const char* p, const char* end);
+    static const char* parseInt(const char* p, const char* end, int &value);
+    static const char* parseDouble(const char* p, const char* end, double &value);
+    static bool parseChunk(const char* p, const char* end, int numV, std::vector<WeightedEdge> &edges);
+    int fd; // file descriptor of the mapped file, -1 if not open
+    const char* data; // start of the mapping
+    size_t length; // size of the mapping
+    const char* body; // first byte after the header
+    int numV; // number of Vertices
 };
 
-Montecarlo::Montecarlo() {
-    srand(time(NULL));    
-}
-
-
-void Montecarlo::run(int vertices, double density, double min_cost, double max_cost){
+GraphFileLoader::GraphFileLoader(const std::string &path){
     
-    for (int i = 0; i < vertices*5 + 2; ++i){
-        std::cout << "=";
-    }
-    std::cout << std::endl;
+    data = nullptr;
+    body = nullptr;
+    length = 0;
+    numV = 0;
     
-    std::cout << "Running simulation..." << std::endl;
-    std::cout << std::endl;
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) return;
     
-    Graph G(vertices);
+    struct stat st;
+    if (fstat(fd, &st) == -1 || st.st_size == 0){
+        close(fd);
+        fd = -1;
+        return;
+    }
     
-    double p, cost;
-    for(int i = 0; i < vertices-1; ++i){
-        for(int j = i + 1; j < vertices; ++j){
+    length = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED){
+        close(fd);
+        fd = -1;
+        length = 0;
+        return;
+    }
+    data = static_cast<const char*>(mapped);
+    madvise(mapped, length, MADV_SEQUENTIAL);
+    
+    body = parseInt(skipSpace(data, data + length), data + length, numV);
+    if (body == nullptr || numV < 0){
+        body = nullptr;
+        numV = 0;
+    }
+}
+
+GraphFileLoader::~GraphFileLoader(){
+    if (data != nullptr){
+        munmap(const_cast<char*>(data), length);
+    }
+    if (fd != -1){
+        close(fd);
+    }
+}
+
+bool GraphFileLoader::isOpen() const{
+    return body != nullptr;
+}
+
+int GraphFileLoader::V() const{
+    return numV;
+}
+
+const char* GraphFileLoader::skipSpace(const char* p, const char* end){
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\t' || *p == '\r')){
+        ++p;
+    }
+    return p;
+}
+
+// Returns the first byte after the number, or nullptr if there is none
+// or it does not fit in an int.
+const char* GraphFileLoader::parseInt(const char* p, const char* end, int &value){
+    
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')){
+        negative = (*p == '-');
+        ++p;
+    }
+    if (p == end || *p < '0' || *p > '9') return nullptr;
+    
+    long long limit = negative ? -static_cast<long long>(INT_MIN) : INT_MAX;
+    long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9'){
+        v = v * 10 + (*p - '0');
+        if (v > limit) return nullptr;
+        ++p;
+    }
+    value = static_cast<int>(negative ? -v : v);
+    return p;
+}
+
+// Decimal with optional fraction and exponent. The digits are gathered 
+// in an integer and scaled by one exact power of ten, which rounds 
+// correctly while the integer fits in 53 bits and |exponent| <= 22; 
+// anything longer falls back to strtod.
+const char* GraphFileLoader::parseDouble(const char* p, const char* end, double &value){
+    
+    static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')){
+        negative = (*p == '-');
+        ++p;
+    }
+    
+    unsigned long long mantissa = 0;
+    int digits = 0, scale = 0;
+    bool any = false;
+    while (p < end && *p >= '0' && *p <= '9'){
+        if (digits < 19){
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0) digits++;
+        } else {
+            scale++;
+        }
+        any = true;
+        ++p;
+    }
+    if (p < end && *p == '.'){
+        ++p;
+        while (p < end && *p >= '0' && *p <= '9'){
+            if (digits < 19){
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa != 0) digits++;
+                scale--;
+            }
+            any = true;
+            ++p;
+        }
+    }
+    if (!any) return nullptr;
+    
+    if (p < end && (*p == 'e' || *p == 'E')){
+        int exponent = 0;
+        const char* q = parseInt(p + 1, end, exponent);
+        if (q != nullptr){
+            scale += exponent;
+            p = q;
+        }
+    }
+    
+    if (digits >= 19 || mantissa > (1ULL << 53) || scale > 22 || scale < -22){
+        std::string token(start, p);
+        value = strtod(token.c_str(), nullptr);
+        return p;
+    }
+    
+    double v = static_cast<double>(mantissa);
+    v = (scale < 0) ? v / powers[-scale] : v * powers[scale];
+    value = negative ? -v : v;
+    return p;
+}
+
+// Parses whole triples until end; false at the first malformed token or
+// vertex id outside [0, numV).
+bool GraphFileLoader::parseChunk(const char* p, const char* end, int numV, std::vector<WeightedEdge> &edges){
+    
+    WeightedEdge we;
+    while ((p = skipSpace(p, end)) < end){
+        p = parseInt(p, end, we.from);
+        if (p == nullptr) return false;
+        p = parseInt(skipSpace(p, end), end, we.to);
+        if (p == nullptr) return false;
+        p = parseDouble(skipSpace(p, end), end, we.cost);
+        if (p == nullptr) return false;
+        if (we.from < 0 || we.from >= numV || we.to < 0 || we.to >= numV) return false;
+        edges.push_back(we);
+    }
+    return true;
+}
+
+bool GraphFileLoader::parse(std::vector<WeightedEdge> &edges, int numThreads){
+    
+    edges.clear();
+    if (!isOpen()) return false;
+    
+    const char* end = data + length;
+    if (numThreads <= 0) numThreads = defaultThreads();
+    // chunks below 1MB are not worth a thread
+    size_t minChunk = 1 << 20;
+    size_t size = static_cast<size_t>(end - body);
+    numThreads = static_cast<int>(std::max<size_t>(1, std::min<size_t>(numThreads, size / minChunk)));
+    
+    // chunk k starts after the first newline following k * size / numThreads
+    std::vector<const char*> bounds(numThreads + 1, end);
+    bounds[0] = body;
+    for (int k = 1; k < numThreads; ++k){
+        const char* p = std::max(bounds[k - 1], body + size / numThreads * k);
+        while (p < end && *p != '\n') ++p;
+        bounds[k] = p;
+    }
+    
+    std::vector<std::vector<WeightedEdge>> chunks(numThreads);
+    std::vector<char> valid(numThreads, 0);
+    parallelFor(numThreads, numThreads, [&](int k, int){
+        chunks[k].reserve(static_cast<size_t>(bounds[k + 1] - bounds[k]) / 8);
+        valid[k] = parseChunk(bounds[k], bounds[k + 1], numV, chunks[k]);
+    });
+    if (std::find(valid.begin(), valid.end(), 0) != valid.end()) return false;
+    
+    size_t total = 0;
+    for (const auto& chunk : chunks){
+        total += chunk.size();
+    }
+    edges.reserve(total);
+    for (const auto& chunk : chunks){
+        edges.insert(edges.end(), chunk.begin(), chunk.end());
+    }
+    return true;
+}
+
+bool GraphFileLoader::loadGraph(Graph &graph, int numThreads){
+    std::vector<WeightedEdge> edges;
+    if (!parse(edges, numThreads)) return false;
+    sortEdgeList(edges);
+    graph = Graph(numV, edges);
+    return true;
+}
+
+bool GraphFileLoader::loadCSR(CSRGraph &graph, int numThreads){
+    std::vector<WeightedEdge> edges;
+    if (!parse(edges, numThreads)) return false;
+    sortEdgeList(edges);
+    graph = CSRGraph(numV, edges);
+    return true;
+}
+
+// ===================================================================== 
+// IndexedHeap class: d-ary min-heap of vertex ids keyed by a double,
+// used as priority queue in ShortestPath and Prim. Every id is queued 
+// at most once and its key can be lowered in place (decrease-key), so
+// the queue holds O(V) entries instead of one per relaxed edge. The 
+// arity D trades a shallower tree against more comparisons per level.
+// ===================================================================== 
+
+template <int D>
+class IndexedHeap{
+    static_assert(D >= 2, "IndexedHeap arity must be at least 2");
+    
+    public:
+        IndexedHeap(int capacity = 0);
+        void reset(int capacity); // empty the heap and accept ids in [0, capacity)
+        void clear(); // empty the heap in O(size), keeping the capacity
+        bool empty() const;
+        int size() const;
+        bool contains(int id) const; // tests whether id is currently queued
+        double key(int id) const; // returns the key of a queued id
+        int top() const; // returns the id with the smallest key
+        double topKey() const; // returns the smallest key
+        void push(int id, double key); // inserts id, or lowers its key if already queued
+        int pop(); // removes and returns the id with the smallest key
+    
+    private:
+        void siftUp(int i);
+        void siftDown(int i);
+        std::vector<int> heap; // queued ids in heap order
+        std::vector<int> pos; // position of each id in heap, -1 if not queued
+        std::vector<double> keys; // key of each id
+};
+
+// Arity used by ShortestPath and Prim
+typedef IndexedHeap<4> VertexQueue;
+
+template <int D>
+IndexedHeap<D>::IndexedHeap(int capacity){
+    reset(capacity);
+}
+
+template <int D>
+void IndexedHeap<D>::reset(int capacity){
+    heap.clear();
+    pos.assign(capacity, -1);
+    keys.assign(capacity, 0.0);
+}
+
+template <int D>
+void IndexedHeap<D>::clear(){
+    for (int id : heap){
+        pos[id] = -1;
+    }
+    heap.clear();
+}
+
+template <int D>
+bool IndexedHeap<D>::empty() const{
+    return heap.empty();
+}
+
+template <int D>
+int IndexedHeap<D>::size() const{
+    return static_cast<int>(heap.size());
+}
+
+template <int D>
+bool IndexedHeap<D>::contains(int id) const{
+    return pos[id] != -1;
+}
+
+template <int D>
+double IndexedHeap<D>::key(int id) const{
+    return keys[id];
+}
+
+template <int D>
+int IndexedHeap<D>::top() const{
+    return heap[0];
+}
+
+template <int D>
+double IndexedHeap<D>::topKey() const{
+    return keys[heap[0]];
+}
+
+template <int D>
+void IndexedHeap<D>::push(int id, double key){
+    
+    if (pos[id] == -1){
+        keys[id] = key;
+        pos[id] = static_cast<int>(heap.size());
+        heap.push_back(id);
+        siftUp(pos[id]);
+    } else if (key < keys[id]){
+        keys[id] = key;
+        siftUp(pos[id]);
+    }
+}
+
+template <int D>
+int IndexedHeap<D>::pop(){
+    
+    int id = heap[0];
+    int last = heap.back();
+    heap.pop_back();
+    pos[id] = -1;
+    if (!heap.empty()){
+        heap[0] = last;
+        pos[last] = 0;
+        siftDown(0);
+    }
+    return id;
+}
+
+template <int D>
+void IndexedHeap<D>::siftUp(int i){
+    
+    int id = heap[i];
+    double k = keys[id];
+    while (i > 0){
+        int parent = (i - 1) / D;
+        if (!(k < keys[heap[parent]])) break;
+        heap[i] = heap[parent];
+        pos[heap[i]] = i;
+        i = parent;
+    }
+    heap[i] = id;
+    pos[id] = i;
+}
+
+template <int D>
+void IndexedHeap<D>::siftDown(int i){
+    
+    int n = static_cast<int>(heap.size());
+    int id = heap[i];
+    double k = keys[id];
+    while (true){
+        int first = D * i + 1;
+        if (first >= n) break;
+        int last = std::min(first + D, n);
+        int best = first;
+        for (int c = first + 1; c < last; ++c){
+            if (keys[heap[c]] < keys[heap[best]]) best = c;
+        }
+        if (!(keys[heap[best]] < k)) break;
+        heap[i] = heap[best];
+        pos[heap[i]] = i;
+        i = best;
+    }
+    heap[i] = id;
+    pos[id] = i;
+}
+
+// ===================================================================== 
+// Integer queues: drop-in replacements for IndexedHeap (same push, pop,
+// empty, contains, key and topKey) when every key is a non-negative
+// integer, e.g. graphs with integer costs. They are picked at compile 
+// time, as in sp.runShortestPath<RadixHeap>(source). Neither supports
+// decrease-key in place: a push leaves the old entry behind and pop 
+// skips entries whose key is no longer the one of their id (lazy 
+// deletion). topKey moves to the smallest key, so it is not const.
+// 
+// RadixHeap: monotone, no key may be pushed below the last one popped,
+// which holds for Dijkstra but not for Prim. Keys go to the bucket of 
+// the highest bit where they differ from the last popped key, and each
+// entry moves down at most 64 times, so push is O(1) and pop O(log C)
+// amortized for keys up to C.
+// 
+// DialQueue: one bucket per key value, kept in a ring that only has to
+// span the queued keys (max cost + 1 buckets for Dijkstra) and doubles 
+// when it does not. Any key can be pushed: the cursor moves back when 
+// a key is lower than it, which serves Prim, whose keys are edge costs.
+// ===================================================================== 
+
+class RadixHeap{
+    
+    public:
+        RadixHeap(int capacity = 0);
+        void reset(int capacity); // empty the heap and accept ids in [0, capacity)
+        void clear();
+        bool empty() const;
+        int size() const;
+        bool contains(int id) const;
+        double key(int id) const;
+        double topKey(); // returns the smallest key
+        void push(int id, double key); // key must not be below the last popped key
+        int pop();
+    
+    private:
+        struct Entry{
+            int id;
+            unsigned long long key;
+        };
+        static int bucketOf(unsigned long long key, unsigned long long last);
+        void refill(); // brings the smallest key into bucket 0
+        std::vector<Entry> buckets[65];
+        std::vector<unsigned long long> keys; // key of each queued id
+        std::vector<char> queued;
+        unsigned long long last; // last popped key
+        int count;
+};
+
+RadixHeap::RadixHeap(int capacity){
+    reset(capacity);
+}
+
+void RadixHeap::reset(int capacity){
+    for (int b = 0; b < 65; ++b){
+        buckets[b].clear();
+    }
+    keys.assign(capacity, 0);
+    queued.assign(capacity, 0);
+    last = 0;
+    count = 0;
+}
+
+void RadixHeap::clear(){
+    for (int b = 0; b < 65; ++b){
+        for (const Entry& e : buckets[b]){
+            queued[e.id] = 0;
+        }
+        buckets[b].clear();
+    }
+    last = 0;
+    count = 0;
+}
+
+bool RadixHeap::empty() const{
+    return count == 0;
+}
+
+int RadixHeap::size() const{
+    return count;
+}
+
+bool RadixHeap::contains(int id) const{
+    return queued[id] != 0;
+}
+
+double RadixHeap::key(int id) const{
+    return static_cast<double>(keys[id]);
+}
+
+double RadixHeap::topKey(){
+    refill();
+    return static_cast<double>(last);
+}
+
+int RadixHeap::bucketOf(unsigned long long key, unsigned long long last){
+    unsigned long long diff = key ^ last;
+#if defined(__GNUC__)
+    return (diff == 0) ? 0 : 64 - __builtin_clzll(diff);
+#else
+    int bit = 0;
+    while (diff != 0){
+        diff >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+void RadixHeap::push(int id, double key){
+    
+    unsigned long long k = static_cast<unsigned long long>(key);
+    if (queued[id]){
+        if (k >= keys[id]) return;
+    } else {
+        queued[id] = 1;
+        count++;
+    }
+    keys[id] = k;
+    Entry e = {id, k};
+    buckets[bucketOf(k, last)].push_back(e);
+}
+
+int RadixHeap::pop(){
+    
+    refill();
+    int id = buckets[0].back().id;
+    buckets[0].pop_back();
+    queued[id] = 0;
+    count--;
+    return id;
+}
+
+// Stale entries are dropped on the way; the heap must not be empty.
+void RadixHeap::refill(){
+    
+    while (true){
+        while (!buckets[0].empty()){
+            const Entry &e = buckets[0].back();
+            if (queued[e.id] && keys[e.id] == e.key) return;
+            buckets[0].pop_back();
+        }
+        int b = 1;
+        while (buckets[b].empty()){
+            b++;
+        }
+        unsigned long long lowest = ~0ULL;
+        for (const Entry& e : buckets[b]){
+            if (queued[e.id] && keys[e.id] == e.key) lowest = std::min(lowest, e.key);
+        }
+        if (lowest != ~0ULL){
+            last = lowest;
+            for (const Entry& e : buckets[b]){
+                if (queued[e.id] && keys[e.id] == e.key) buckets[bucketOf(e.key, last)].push_back(e);
+            }
+        }
+        buckets[b].clear();
+    }
+}
+
+class DialQueue{
+    
+    public:
+        DialQueue(int capacity = 0);
+        void reset(int capacity); // empty the queue and accept ids in [0, capacity)
+        void clear();
+        bool empty() const;
+        int size() const;
+        bool contains(int id) const;
+        double key(int id) const;
+        double topKey(); // returns the smallest key
+        void push(int id, double key); // inserts id, or lowers its key if already queued
+        int pop();
+    
+    private:
+        bool live(int id, unsigned long long key) const;
+        void grow(unsigned long long span); // makes the ring hold span consecutive keys
+        void advance(); // moves the cursor to the smallest key
+        std::vector<std::vector<int>> buckets; // ring of buckets, bucket of key k at k & mask
+        unsigned long long mask;
+        unsigned long long cursor; // no queued key is lower
+        unsigned long long highest; // no queued key is higher
+        std::vector<unsigned long long> keys;
+        std::vector<char> queued;
+        int count;
+};
+
+DialQueue::DialQueue(int capacity){
+    reset(capacity);
+}
+
+void DialQueue::reset(int capacity){
+    buckets.assign(64, std::vector<int>());
+    mask = 63;
+    cursor = highest = 0;
+    keys.assign(capacity, 0);
+    queued.assign(capacity, 0);
+    count = 0;
+}
+
+void DialQueue::clear(){
+    for (std::vector<int> &bucket : buckets){
+        for (int id : bucket){
+            queued[id] = 0;
+        }
+        bucket.clear();
+    }
+    cursor = highest = 0;
+    count = 0;
+}
+
+bool DialQueue::empty() const{
+    return count == 0;
+}
+
+int DialQueue::size() const{
+    return count;
+}
+
+bool DialQueue::contains(int id) const{
+    return queued[id] != 0;
+}
+
+double DialQueue::key(int id) const{
+    return static_cast<double>(keys[id]);
+}
+
+double DialQueue::topKey(){
+    advance();
+    return static_cast<double>(cursor);
+}
+
+bool DialQueue::live(int id, unsigned long long key) const{
+    return queued[id] && keys[id] == key;
+}
+
+void DialQueue::push(int id, double key){
+    
+    unsigned long long k = static_cast<unsigned long long>(key);
+    if (queued[id]){
+        if (k >= keys[id]) return;
+    } else {
+        queued[id] = 1;
+        count++;
+    }
+    if (count == 1){
+        cursor = highest = k;
+    }
+    unsigned long long low = std::min(cursor, k), high = std::max(highest, k);
+    if (high - low > mask){
+        grow(high - low + 1);
+    }
+    cursor = low;
+    highest = high;
+    keys[id] = k;
+    buckets[k & mask].push_back(id);
+}
+
+int DialQueue::pop(){
+    
+    advance();
+    std::vector<int> &bucket = buckets[cursor & mask];
+    int id = bucket.back();
+    bucket.pop_back();
+    queued[id] = 0;
+    count--;
+    return id;
+}
+
+// Drops stale entries of the cursor bucket and skips empty buckets; 
+// the queue must not be empty.
+void DialQueue::advance(){
+    
+    while (true){
+        // the ring spans the queued keys, so a live entry of this slot
+        // has the key of the cursor
+        std::vector<int> &bucket = buckets[cursor & mask];
+        while (!bucket.empty() && !live(bucket.back(), cursor)){
+            bucket.pop_back();
+        }
+        if (!bucket.empty()) return;
+        cursor++;
+    }
+}
+
+void DialQueue::grow(unsigned long long span){
+    
+    unsigned long long size = mask + 1;
+    while (size < span){
+        size *= 2;
+    }
+    std::vector<std::vector<int>> old(size);
+    old.swap(buckets);
+    mask = size - 1;
+    for (std::vector<int> &bucket : old){
+        for (int id : bucket){
+            if (queued[id]) buckets[keys[id] & mask].push_back(id);
+        }
+    }
+}
+
+// ===================================================================== 
+// ShortestPath Class (using Dijkstra)
+// ===================================================================== 
+
+class ShortestPath{
+    public:
+        ShortestPath();
+        ShortestPath(Graph *graph);
+        ShortestPath(const CSRGraph *graph);
+        void addGraph(Graph *graph);
+        void addGraph(const CSRGraph *graph);
+        template <class Queue = VertexQueue>
+        void runShortestPath(int source); // Queue: VertexQueue, or RadixHeap or DialQueue for integer costs
+        double avgPathLenght() const;
+        double avgPathDist() const;
+        std::list<int> path(int from, int to);
+        int pathSize(int from, int to);
+        double minDist(int from, int to);
+        const std::vector<double>& getDistances() const; // distances from the last source, infinity if unreachable
+        const std::vector<int>& getPredecessors() const; // predecessors on the last run, -1 if unreachable
+    
+    private:
+        template <class Queue, class GraphT>
+        void search(const GraphT &graph, int source);
+        bool reached(int to) const;
+        Graph* g;
+        const CSRGraph* csr;
+        int last_run;
+        std::vector<double> min_distances; // distance of every vertex from last_run
+        std::vector<int> predecessors; // previous vertex on the shortest path
+        std::vector<int> path_sizes; // number of edges on the shortest path
+        double avg_path_length;
+        double avg_path_dist;
+};
+
+ShortestPath::ShortestPath() {
+    g = nullptr;
+    csr = nullptr;
+    last_run = -1;
+}
+
+ShortestPath::ShortestPath(Graph *graph){
+    g = graph;
+    csr = nullptr;
+    last_run = -1;
+}
+
+ShortestPath::ShortestPath(const CSRGraph *graph){
+    g = nullptr;
+    csr = graph;
+    last_run = -1;
+}
+
+
+void ShortestPath::addGraph(Graph *graph){
+    g = graph;
+    csr = nullptr;
+    last_run = -1;
+}
+
+
+void ShortestPath::addGraph(const CSRGraph *graph){
+    g = nullptr;
+    csr = graph;
+    last_run = -1;
+}
+
+
+double ShortestPath::avgPathLenght() const {
+    return avg_path_length;
+}
+
+
+double ShortestPath::avgPathDist() const {
+    return avg_path_dist;
+}
+
+
+const std::vector<double>& ShortestPath::getDistances() const {
+    return min_distances;
+}
+
+
+const std::vector<int>& ShortestPath::getPredecessors() const {
+    return predecessors;
+}
+
+
+// The source itself is reported as having no path, as before.
+bool ShortestPath::reached(int to) const {
+    return to != last_run && predecessors[to] != -1;
+}
+
+
+// The path is rebuilt from the predecessor array on request.
+std::list<int> ShortestPath::path(int from, int to){
+    
+    if (from != last_run){
+        runShortestPath(from);
+    }
+    
+    std::list<int> el;
+    if (reached(to)){
+        for (int cursor = to; cursor != from; cursor = predecessors[cursor]){
+            el.push_front(cursor);
+        }
+        el.push_front(from);
+    }
+    
+    return el;
+}
+
+
+int ShortestPath::pathSize(int from, int to){
+    
+    if (from != last_run){
+        runShortestPath(from);
+    }
+    
+    if (reached(to)) {
+        return path_sizes[to];    
+    }
+    
+    return INT_MAX;       
+}
+
+
+double ShortestPath::minDist(int from, int to){
+    
+    if (from != last_run){
+        runShortestPath(from);
+    }
+    
+    if (reached(to)){
+        return min_distances[to];
+    }
+    
+    return static_cast<double>(INT_MAX);
+}
+
+
+template <class Queue>
+void ShortestPath::runShortestPath(int source){
+    
+    last_run = source;
+    avg_path_length = 0.0;
+    avg_path_dist = 0.0;
+    
+    if (csr != nullptr){
+        search<Queue>(*csr, source);
+    } else {
+        search<Queue>(*g, source);
+    }
+    
+    int path_counter = 0;
+    for (int i = 0; i < static_cast<int>(predecessors.size()); ++i){
+        
+        if (!reached(i)) continue;
+        
+        path_counter++;
+        avg_path_length += (path_sizes[i] - avg_path_length) / path_counter;
+        avg_path_dist += (min_distances[i] - avg_path_dist) / path_counter;
+        
+    }
+        
+}
+
+
+// Dijkstra search over any graph exposing edges(x) as a range of Edge.
+template <class Queue, class GraphT>
+void ShortestPath::search(const GraphT &graph, int source){
+    
+    int n = graph.V();
+    min_distances.assign(n, std::numeric_limits<double>::infinity());
+    predecessors.assign(n, -1);
+    path_sizes.assign(n, 0);
+    
+    Queue pq(n);
+    std::vector<bool> closed(n, false);
+    
+    min_distances[source] = 0.0;
+    predecessors[source] = source;
+    pq.push(source, 0.0);
+    
+    while (!pq.empty()){
+        
+        int curr = pq.pop();
+        closed[curr] = true;
+        
+        double base = min_distances[curr];
+        for(const Edge& e : graph.edges(curr)){
+            if (closed[e.to]) continue;
+            double dist = base + e.cost;
+            if (dist < min_distances[e.to]){
+                min_distances[e.to] = dist;
+                predecessors[e.to] = curr;
+                path_sizes[e.to] = path_sizes[curr] + 1;
+                pq.push(e.to, dist);
+            }
+        }
+        
+    }
+}
+
+// ===================================================================== 
+// Montecarlo simulaiton
+// ===================================================================== 
+
+class Montecarlo{
+    public:
+        Montecarlo();
+        void run(int vertices, double density, double min_cost, double max_cost); 
+};
+
+Montecarlo::Montecarlo() {
+    srand(time(NULL));    
+}
+
+
+void Montecarlo::run(int vertices, double density, double min_cost, double max_cost){
+    
+    for (int i = 0; i < vertices*5 + 2; ++i){
+        std::cout << "=";
+    }
+    std::cout << std::endl;
+    
+    std::cout << "Running simulation..." << std::endl;
+    std::cout << std::endl;
+    
+    Graph G(vertices);
+    
+    double p, cost;
+    for(int i = 0; i < vertices-1; ++i){
+        for(int j = i + 1; j < vertices; ++j){
             p = static_cast<double>(rand()) / RAND_MAX;
             if (p <= density){
                 cost = (p/density) * (max_cost - min_cost) + min_cost;
@@ -436,130 +1774,1061 @@ void Montecarlo::run(int vertices, double density, double min_cost, double max_c
     std::cout << "Average (Shortest Dijkstra)Path distance: " << std::setprecision(2) << DSP.avgPathDist() << std::endl;
     std::cout << std::endl;
     
-    std::cout << "Adjacency Matrix" << std::endl;
-    G.printAdjMatrix();
+    std::cout << "Adjacency Matrix" << std::endl;
+    G.printAdjMatrix();
+    
+    std::cout << std::endl;
+    
+    std::cout << "Shortest Paths from 0:" << std::endl;
+    
+    for (int i = 1; i < G.V(); ++i){
+        
+        std::cout << "To " << std::setw(2) << i << " (" << std::setw(7) << std::setprecision(2) << DSP.minDist(0, i) << "): ";
+        auto path = DSP.path(0, i);
+        for (auto it = path.begin(); it != path.end(); ++it){
+            std::cout << *it;
+            if (it != --path.end()){
+                std::cout << " -> ";
+            }
+        }
+        std::cout << std::endl;
+    }
+    
+    for (int i = 0; i < vertices*5 + 2; ++i){
+        std::cout << "=";
+    }
+    std::cout << std::endl;
+}
+
+// =====================================================================
+// Prim algorithm class
+// =====================================================================
+
+class Prim{
+public:
+    Prim();
+    Prim(Graph *graph);
+    Prim(const CSRGraph *graph);
+    void addGraph(Graph *graph);
+    void addGraph(const CSRGraph *graph);
+    template <class Queue = VertexQueue>
+    void run(int source); // Queue: VertexQueue, or DialQueue for integer costs
+    template <class Queue = VertexQueue>
+    void runForest(int numThreads = 0); // minimum spanning forest over every component
+    Graph getMST() const;
+    double getMSTCost() const;
+    int components() const; // number of trees found by the last run
+    const std::vector<double>& getComponentCosts() const; // cost of each tree
+
+private:
+    template <class GraphT, class Queue>
+    static double grow(const GraphT &graph, int source, Queue &pq, std::vector<char> &visited,
+                       std::vector<int> &parent, std::vector<WeightedEdge> &tree);
+    template <class Queue, class GraphT>
+    void growForest(const GraphT &graph, int numThreads);
+    Graph *g;
+    const CSRGraph *csr;
+    Graph MST;
+    double MSTCost;
+    std::vector<double> componentCosts;
+};
+
+Prim::Prim(){
+    MSTCost = 0.0;
+    g = nullptr;
+    csr = nullptr;
+}
+
+Prim::Prim(Graph *graph)
+{
+    MSTCost = 0.0;
+    g = graph;
+    csr = nullptr;
+    Graph newMST((*graph).V());
+    MST = newMST;
+}
+
+Prim::Prim(const CSRGraph *graph)
+{
+    MSTCost = 0.0;
+    g = nullptr;
+    csr = graph;
+    Graph newMST((*graph).V());
+    MST = newMST;
+}
+
+void Prim::addGraph(Graph *graph){
+    MSTCost = 0.0;
+    g = graph;
+    csr = nullptr;
+    Graph newMST((*graph).V());
+    MST = newMST;
+}
+
+void Prim::addGraph(const CSRGraph *graph){
+    MSTCost = 0.0;
+    g = nullptr;
+    csr = graph;
+    Graph newMST((*graph).V());
+    MST = newMST;
+}
+
+// Grows the tree of the component holding source only; on disconnected
+// input use runForest.
+template <class Queue>
+void Prim::run(int source){
+
+    int n = (csr != nullptr) ? csr->V() : g->V();
+    Queue pq(n);
+    std::vector<char> visited(n, 0);
+    std::vector<int> parent(n, -1);
+    std::vector<WeightedEdge> tree;
+
+    if (csr != nullptr){
+        MSTCost = grow(*csr, source, pq, visited, parent, tree);
+    } else {
+        MSTCost = grow(*g, source, pq, visited, parent, tree);
+    }
+    MST = Graph(n, tree);
+    componentCosts.assign(1, MSTCost);
+}
+
+template <class Queue>
+void Prim::runForest(int numThreads){
+
+    if (csr != nullptr){
+        growForest<Queue>(*csr, numThreads);
+    } else {
+        growForest<Queue>(*g, numThreads);
+    }
+}
+
+// Prim search over any graph exposing edges(x) as a range of Edge. It 
+// appends the tree edges of the component of source and returns their
+// cost. Only unvisited targets are ever queued; visited and parent may
+// be shared by concurrent calls on different components.
+template <class GraphT, class Queue>
+double Prim::grow(const GraphT &graph, int source, Queue &pq, std::vector<char> &visited,
+                  std::vector<int> &parent, std::vector<WeightedEdge> &tree){
+
+    double treeCost = 0.0;
+    pq.push(source, 0.0);
+
+    while (!pq.empty()){
+
+        double cost = pq.topKey();
+        int curr = pq.pop();
+        visited[curr] = 1;
+        if (parent[curr] != -1){
+            WeightedEdge we = {parent[curr], curr, cost};
+            tree.push_back(we);
+            treeCost += cost;
+        }
+
+        for (const Edge& e : graph.edges(curr))
+        {
+            if (visited[e.to]) continue;
+            if (!pq.contains(e.to) || e.cost < pq.key(e.to))
+            {
+                pq.push(e.to, e.cost);
+                parent[e.to] = curr;
+            }
+        }
+
+    }
+    return treeCost;
+}
+
+// Labels the components with a BFS, then grows one tree per component,
+// largest first, on a pool of threads that each reuse their own heap.
+template <class Queue, class GraphT>
+void Prim::growForest(const GraphT &graph, int numThreads){
+
+    int n = graph.V();
+    std::vector<int> comp(n, -1);
+    std::vector<int> roots, sizes, frontier;
+    for (int v = 0; v < n; ++v){
+        if (comp[v] != -1) continue;
+        int id = static_cast<int>(roots.size());
+        roots.push_back(v);
+        sizes.push_back(0);
+        comp[v] = id;
+        frontier.assign(1, v);
+        while (!frontier.empty()){
+            int curr = frontier.back();
+            frontier.pop_back();
+            sizes[id]++;
+            for (int y : graph.neighbors(curr)){
+                if (comp[y] == -1){
+                    comp[y] = id;
+                    frontier.push_back(y);
+                }
+            }
+        }
+    }
+
+    int numComponents = static_cast<int>(roots.size());
+    std::vector<int> order(numComponents);
+    for (int c = 0; c < numComponents; ++c){
+        order[c] = c;
+    }
+    std::sort(order.begin(), order.end(), [&](int a, int b){ return sizes[a] > sizes[b]; });
+
+    if (numThreads <= 0) numThreads = defaultThreads();
+    numThreads = std::max(1, std::min(numThreads, numComponents));
+    std::vector<Queue> queues(numThreads, Queue(n));
+    std::vector<char> visited(n, 0);
+    std::vector<int> parent(n, -1);
+    std::vector<std::vector<WeightedEdge>> trees(numComponents);
+    componentCosts.assign(numComponents, 0.0);
+
+    parallelFor(numComponents, numThreads, [&](int i, int thread){
+        int c = order[i];
+        componentCosts[c] = grow(graph, roots[c], queues[thread], visited, parent, trees[c]);
+    });
+
+    std::vector<WeightedEdge> forest;
+    forest.reserve(n);
+    MSTCost = 0.0;
+    for (int c = 0; c < numComponents; ++c){
+        forest.insert(forest.end(), trees[c].begin(), trees[c].end());
+        MSTCost += componentCosts[c];
+    }
+    MST = Graph(n, forest);
+}
+
+Graph Prim::getMST() const{
+    return MST;
+}
+
+double Prim::getMSTCost() const{
+    return MSTCost;
+}
+
+int Prim::components() const{
+    return static_cast<int>(componentCosts.size());
+}
+
+const std::vector<double>& Prim::getComponentCosts() const{
+    return componentCosts;
+}
+
+// =====================================================================
+// DisjointSet class: union-find with path compression and union by 
+// rank, so find and unite are amortized near constant time.
+// =====================================================================
+
+class DisjointSet{
+public:
+    DisjointSet(int n = 0);
+    void reset(int n);
+    int find(int x);
+    bool unite(int x, int y); // merges the sets of x and y, false if already joined
+    int components() const; // returns the number of disjoint sets
+
+private:
+    std::vector<int> parent;
+    std::vector<unsigned char> rank;
+    int numSets;
+};
+
+DisjointSet::DisjointSet(int n){
+    reset(n);
+}
+
+void DisjointSet::reset(int n){
+    parent.resize(n);
+    for (int i = 0; i < n; ++i){
+        parent[i] = i;
+    }
+    rank.assign(n, 0);
+    numSets = n;
+}
+
+int DisjointSet::find(int x){
+    int root = x;
+    while (parent[root] != root){
+        root = parent[root];
+    }
+    while (parent[x] != root){
+        int next = parent[x];
+        parent[x] = root;
+        x = next;
+    }
+    return root;
+}
+
+bool DisjointSet::unite(int x, int y){
+    x = find(x);
+    y = find(y);
+    if (x == y)
+        return false;
+    if (rank[x] < rank[y])
+        std::swap(x, y);
+    parent[y] = x;
+    if (rank[x] == rank[y])
+        rank[x]++;
+    numSets--;
+    return true;
+}
+
+int DisjointSet::components() const{
+    return numSets;
+}
+
+// =====================================================================
+// Edge list helpers shared by the edge based MST algorithms
+// =====================================================================
+
+// Orders edges by cost, ties broken by endpoints so that every run (and 
+// every algorithm) picks the same tree.
+bool lighterEdge(const WeightedEdge &a, const WeightedEdge &b){
+    if (a.cost != b.cost) return a.cost < b.cost;
+    if (a.from != b.from) return a.from < b.from;
+    return a.to < b.to;
+}
+
+// Collects every undirected edge once, as (from, to) with from < to.
+template <class GraphT>
+std::vector<WeightedEdge> undirectedEdges(const GraphT &graph){
+    std::vector<WeightedEdge> edges;
+    edges.reserve(graph.E() / 2);
+    for (int i = 0; i < graph.V(); ++i){
+        for (const Edge& e : graph.edges(i)){
+            if (i < e.to){
+                WeightedEdge we = {i, e.to, e.cost};
+                edges.push_back(we);
+            }
+        }
+    }
+    return edges;
+}
+
+// Sorts chunks of the list on separate threads, then merges pairs of 
+// neighbouring runs in parallel until a single run is left.
+void parallelSortEdges(std::vector<WeightedEdge> &edges, int numThreads){
+    
+    if (numThreads <= 0) numThreads = defaultThreads();
+    size_t n = edges.size();
+    // below 64k edges per chunk a thread costs more than it saves
+    int chunks = static_cast<int>(std::max<size_t>(1, std::min<size_t>(numThreads, n / 65536)));
     
-    std::cout << std::endl;
+    std::vector<size_t> bounds(chunks + 1);
+    for (int k = 0; k <= chunks; ++k){
+        bounds[k] = n * k / chunks;
+    }
     
-    std::cout << "Shortest Paths from 0:" << std::endl;
+    parallelFor(chunks, numThreads, [&](int k, int){
+        std::sort(edges.begin() + bounds[k], edges.begin() + bounds[k + 1], lighterEdge);
+    });
     
-    for (int i = 1; i < G.V(); ++i){
-        
-        std::cout << "To " << std::setw(2) << i << " (" << std::setw(7) << std::setprecision(2) << DSP.minDist(0, i) << "): ";
-        auto path = DSP.path(0, i);
-        for (auto it = path.begin(); it != path.end(); ++it){
-            std::cout << *it;
-            if (it != --path.end()){
-                std::cout << " -> ";
+    for (int width = 1; width < chunks; width *= 2){
+        int merges = (chunks + 2 * width - 1) / (2 * width);
+        parallelFor(merges, numThreads, [&](int m, int){
+            int lo = 2 * width * m;
+            int mid = std::min(lo + width, chunks);
+            int hi = std::min(lo + 2 * width, chunks);
+            if (mid < hi){
+                std::inplace_merge(edges.begin() + bounds[lo], edges.begin() + bounds[mid],
+                                   edges.begin() + bounds[hi], lighterEdge);
             }
-        }
-        std::cout << std::endl;
+        });
     }
-    
-    for (int i = 0; i < vertices*5 + 2; ++i){
-        std::cout << "=";
-    }
-    std::cout << std::endl;
 }
 
 // =====================================================================
-// Prim algorithm class
+// Kruskal algorithm class: sorts all the edges once (in parallel) and
+// keeps each edge that joins two different trees of a DisjointSet. The
+// tree is returned as a flat edge list; on a disconnected graph it is 
+// a minimum spanning forest.
 // =====================================================================
 
-class Prim{
+class Kruskal{
 public:
-    Prim();
-    Prim(Graph *graph);
+    Kruskal();
+    Kruskal(Graph *graph);
+    Kruskal(const CSRGraph *graph);
     void addGraph(Graph *graph);
-    void run(int source);
+    void addGraph(const CSRGraph *graph);
+    void run(int numThreads = 0);
+    const std::vector<WeightedEdge>& getMSTEdges() const;
     Graph getMST() const;
     double getMSTCost() const;
 
 private:
     Graph *g;
-    Graph MST;
+    const CSRGraph *csr;
+    int numV;
+    std::vector<WeightedEdge> MSTEdges;
     double MSTCost;
 };
 
-Prim::Prim(){
+Kruskal::Kruskal(){
+    g = nullptr;
+    csr = nullptr;
+    numV = 0;
     MSTCost = 0.0;
 }
 
-Prim::Prim(Graph *graph)
-{
-    MSTCost = 0.0;
+Kruskal::Kruskal(Graph *graph){
+    addGraph(graph);
+}
+
+Kruskal::Kruskal(const CSRGraph *graph){
+    addGraph(graph);
+}
+
+void Kruskal::addGraph(Graph *graph){
     g = graph;
-    Graph newMST((*graph).V());
-    MST = newMST;
+    csr = nullptr;
+    numV = graph->V();
+    MSTEdges.clear();
+    MSTCost = 0.0;
 }
 
-void Prim::addGraph(Graph *graph){
+void Kruskal::addGraph(const CSRGraph *graph){
+    g = nullptr;
+    csr = graph;
+    numV = graph->V();
+    MSTEdges.clear();
+    MSTCost = 0.0;
+}
+
+void Kruskal::run(int numThreads){
+
+    std::vector<WeightedEdge> edges = (csr != nullptr) ? undirectedEdges(*csr) : undirectedEdges(*g);
+    parallelSortEdges(edges, numThreads);
+
+    DisjointSet forest(numV);
+    MSTEdges.clear();
+    MSTCost = 0.0;
+    for (const WeightedEdge& we : edges){
+        if (forest.unite(we.from, we.to)){
+            MSTEdges.push_back(we);
+            MSTCost += we.cost;
+            if (forest.components() == 1)
+                break;
+        }
+    }
+}
+
+const std::vector<WeightedEdge>& Kruskal::getMSTEdges() const{
+    return MSTEdges;
+}
+
+Graph Kruskal::getMST() const{
+    return Graph(numV, MSTEdges);
+}
+
+double Kruskal::getMSTCost() const{
+    return MSTCost;
+}
+
+// =====================================================================
+// Boruvka algorithm class: every round each component picks its 
+// cheapest outgoing edge, all those edges join the tree and the 
+// components they link are contracted. The edge scan of a round is 
+// split over threads, which publish candidates with a compare-and-swap 
+// on the component's slot; there are at most log2(V) rounds. With ties
+// broken by lighterEdge the chosen edges never close a cycle, and the
+// tree cost matches Prim's.
+// =====================================================================
+
+class Boruvka{
+public:
+    Boruvka();
+    Boruvka(Graph *graph);
+    Boruvka(const CSRGraph *graph);
+    void addGraph(Graph *graph);
+    void addGraph(const CSRGraph *graph);
+    void run(int numThreads = 0);
+    const std::vector<WeightedEdge>& getMSTEdges() const;
+    Graph getMST() const;
+    double getMSTCost() const;
+
+private:
+    Graph *g;
+    const CSRGraph *csr;
+    int numV;
+    std::vector<WeightedEdge> MSTEdges;
+    double MSTCost;
+};
+
+Boruvka::Boruvka(){
+    g = nullptr;
+    csr = nullptr;
+    numV = 0;
     MSTCost = 0.0;
+}
+
+Boruvka::Boruvka(Graph *graph){
+    addGraph(graph);
+}
+
+Boruvka::Boruvka(const CSRGraph *graph){
+    addGraph(graph);
+}
+
+void Boruvka::addGraph(Graph *graph){
     g = graph;
-    Graph newMST((*graph).V());
-    MST = newMST;
+    csr = nullptr;
+    numV = graph->V();
+    MSTEdges.clear();
+    MSTCost = 0.0;
 }
 
-void Prim::run(int source){
+void Boruvka::addGraph(const CSRGraph *graph){
+    g = nullptr;
+    csr = graph;
+    numV = graph->V();
+    MSTEdges.clear();
+    MSTCost = 0.0;
+}
+
+void Boruvka::run(int numThreads){
+
+    if (numThreads <= 0) numThreads = defaultThreads();
 
-    std::priority_queue<NodeInfo> pq;
-    std::set<int> visited;
+    std::vector<WeightedEdge> edges = (csr != nullptr) ? undirectedEdges(*csr) : undirectedEdges(*g);
+    MSTEdges.clear();
+    MSTCost = 0.0;
 
-    int curr = source;
-    auto edges = (*g).getEdges(curr);
-    for (auto it = edges.begin(); it != edges.end(); ++it)
-    {
-        NodeInfo n = {curr, (it->second).to, (it->second).cost};
-        pq.push(n);
+    // component label of every vertex, kept dense in [0, numComponents)
+    std::vector<int> comp(numV);
+    for (int i = 0; i < numV; ++i){
+        comp[i] = i;
     }
-    visited.insert(curr);
+    int numComponents = numV;
+    // a slice of the edge list or of the vertices per thread
+    auto slice = [](size_t n, int parts, int k){ return n * k / parts; };
+
+    while (!edges.empty()){
 
-    while (visited.size() != (*g).V()){
+        // cheapest edge leaving every component, as an index into edges
+        std::vector<std::atomic<int>> best(numComponents);
+        parallelFor(numThreads, numThreads, [&](int t, int){
+            for (size_t c = slice(numComponents, numThreads, t); c < slice(numComponents, numThreads, t + 1); ++c){
+                best[c].store(-1, std::memory_order_relaxed);
+            }
+        });
+
+        parallelFor(numThreads, numThreads, [&](int t, int){
+            for (size_t k = slice(edges.size(), numThreads, t); k < slice(edges.size(), numThreads, t + 1); ++k){
+                int ends[2] = {comp[edges[k].from], comp[edges[k].to]};
+                for (int c : ends){
+                    int current = best[c].load(std::memory_order_relaxed);
+                    while ((current == -1 || lighterEdge(edges[k], edges[current])) &&
+                           !best[c].compare_exchange_weak(current, static_cast<int>(k), std::memory_order_relaxed)){
+                    }
+                }
+            }
+        });
+
+        // contract: join every component with its cheapest neighbour
+        DisjointSet merged(numComponents);
+        for (int c = 0; c < numComponents; ++c){
+            int k = best[c].load(std::memory_order_relaxed);
+            if (k != -1 && merged.unite(comp[edges[k].from], comp[edges[k].to])){
+                MSTEdges.push_back(edges[k]);
+                MSTCost += edges[k].cost;
+            }
+        }
 
-        NodeInfo top = pq.top();
-        pq.pop();
-        if (!visited.count(top.to)){
-            MST.addEdge(top.from, top.to, top.dist);
-            MSTCost += top.dist;
+        std::vector<int> label(numComponents, -1);
+        int next = 0;
+        for (int c = 0; c < numComponents; ++c){
+            int root = merged.find(c);
+            if (label[root] == -1)
+                label[root] = next++;
+            label[c] = label[root];
         }
+        numComponents = next;
 
-        curr = top.to;
-        edges = (*g).getEdges(curr);
-        for (auto it = edges.begin(); it != edges.end(); ++it)
-        {
-            if (!visited.count((it->second).to))
-            {
-                NodeInfo n = {curr, (it->second).to, (it->second).cost};
-                pq.push(n);
+        parallelFor(numThreads, numThreads, [&](int t, int){
+            for (size_t v = slice(numV, numThreads, t); v < slice(numV, numThreads, t + 1); ++v){
+                comp[v] = label[comp[v]];
             }
+        });
+
+        // drop the edges that now lie inside a component
+        std::vector<std::vector<WeightedEdge>> kept(numThreads);
+        parallelFor(numThreads, numThreads, [&](int t, int){
+            for (size_t k = slice(edges.size(), numThreads, t); k < slice(edges.size(), numThreads, t + 1); ++k){
+                if (comp[edges[k].from] != comp[edges[k].to])
+                    kept[t].push_back(edges[k]);
+            }
+        });
+        edges.clear();
+        for (const auto& part : kept){
+            edges.insert(edges.end(), part.begin(), part.end());
+        }
+    }
+}
+
+const std::vector<WeightedEdge>& Boruvka::getMSTEdges() const{
+    return MSTEdges;
+}
+
+Graph Boruvka::getMST() const{
+    return Graph(numV, MSTEdges);
+}
+
+double Boruvka::getMSTCost() const{
+    return MSTCost;
+}
+
+// =====================================================================
+// MSTSolver class: picks Prim or Kruskal from the density of the graph.
+// Prim with the indexed heap costs O(E log V) and walks adjacency in 
+// place, Kruskal costs a sort of all the edges but only a flat pass 
+// afterwards, so Kruskal wins on sparse graphs and Prim on dense ones.
+// Either way the result is the minimum spanning forest of the graph.
+// =====================================================================
+
+enum class MSTAlgorithm {AUTO, PRIM, KRUSKAL};
+
+class MSTSolver{
+public:
+    MSTSolver(const CSRGraph *graph, MSTAlgorithm algorithm = MSTAlgorithm::AUTO);
+    void run(int numThreads = 0);
+    MSTAlgorithm algorithm() const; // the algorithm that run() used
+    const std::vector<WeightedEdge>& getMSTEdges() const;
+    double getMSTCost() const;
+
+    static constexpr double KRUSKAL_MAX_DENSITY = 0.05; // Kruskal below this density
+
+private:
+    const CSRGraph *csr;
+    MSTAlgorithm chosen;
+    std::vector<WeightedEdge> MSTEdges;
+    double MSTCost;
+};
+
+constexpr double MSTSolver::KRUSKAL_MAX_DENSITY;
+
+MSTSolver::MSTSolver(const CSRGraph *graph, MSTAlgorithm algorithm){
+    csr = graph;
+    chosen = algorithm;
+    MSTCost = 0.0;
+    if (chosen == MSTAlgorithm::AUTO){
+        double V = static_cast<double>(graph->V());
+        double density = (V > 1) ? graph->E() / (V * (V - 1)) : 1.0;
+        chosen = (density < KRUSKAL_MAX_DENSITY) ? MSTAlgorithm::KRUSKAL : MSTAlgorithm::PRIM;
+    }
+}
+
+void MSTSolver::run(int numThreads){
+
+    if (chosen == MSTAlgorithm::KRUSKAL){
+        Kruskal kruskal(csr);
+        kruskal.run(numThreads);
+        MSTEdges = kruskal.getMSTEdges();
+        MSTCost = kruskal.getMSTCost();
+    } else {
+        Prim prim(csr);
+        prim.runForest(numThreads);
+        Graph MST = prim.getMST();
+        MSTEdges = undirectedEdges(MST);
+        MSTCost = prim.getMSTCost();
+    }
+}
+
+MSTAlgorithm MSTSolver::algorithm() const{
+    return chosen;
+}
+
+const std::vector<WeightedEdge>& MSTSolver::getMSTEdges() const{
+    return MSTEdges;
+}
+
+double MSTSolver::getMSTCost() const{
+    return MSTCost;
+}
+
+// =====================================================================
+// LinkCutTree class: a forest of rooted trees stored as splay trees of
+// preferred paths (Sleator and Tarjan). link, cut, connected and the 
+// heaviest node on a path cost O(log n) amortized. Every node carries a
+// cost; to weigh edges, give each edge its own node between the two
+// endpoints and give the vertex nodes minus infinity.
+// =====================================================================
+
+class LinkCutTree{
+public:
+    LinkCutTree(int n = 0);
+    void reset(int n); // n isolated nodes of cost minus infinity
+    void setCost(int x, double c);
+    double getCost(int x) const;
+    bool connected(int x, int y);
+    void link(int x, int y); // joins the trees of x and y, which must differ
+    void cut(int x, int y); // removes the link x - y, which must exist
+    int pathMax(int x, int y); // node with the largest cost on the path x - y
+
+private:
+    struct LCTNode{
+        int child[2];
+        int parent; // splay parent, or path parent when x is a splay root
+        bool flip; // pending reversal of the subtree
+        double cost;
+        int best; // node with the largest cost in the splay subtree
+    };
+    bool isRoot(int x) const;
+    void push(int x);
+    void pull(int x);
+    void rotate(int x);
+    void splay(int x);
+    void access(int x);
+    void makeRoot(int x);
+    int findRoot(int x);
+    std::vector<LCTNode> nodes;
+    std::vector<int> stack; // pending flips on the way to a splay root
+};
+
+LinkCutTree::LinkCutTree(int n){
+    reset(n);
+}
+
+void LinkCutTree::reset(int n){
+    LCTNode empty = {{-1, -1}, -1, false, -std::numeric_limits<double>::infinity(), 0};
+    nodes.assign(n, empty);
+    for (int i = 0; i < n; ++i){
+        nodes[i].best = i;
+    }
+}
+
+void LinkCutTree::setCost(int x, double c){
+    access(x);
+    splay(x);
+    nodes[x].cost = c;
+    pull(x);
+}
+
+double LinkCutTree::getCost(int x) const{
+    return nodes[x].cost;
+}
+
+bool LinkCutTree::connected(int x, int y){
+    return x == y || findRoot(x) == findRoot(y);
+}
+
+void LinkCutTree::link(int x, int y){
+    makeRoot(x);
+    nodes[x].parent = y;
+}
+
+void LinkCutTree::cut(int x, int y){
+    makeRoot(x);
+    access(y);
+    splay(y);
+    // the path is now x - y, so x is the only left child of y
+    nodes[y].child[0] = -1;
+    nodes[x].parent = -1;
+    pull(y);
+}
+
+int LinkCutTree::pathMax(int x, int y){
+    makeRoot(x);
+    access(y);
+    splay(y);
+    return nodes[y].best;
+}
+
+bool LinkCutTree::isRoot(int x) const{
+    int p = nodes[x].parent;
+    return p == -1 || (nodes[p].child[0] != x && nodes[p].child[1] != x);
+}
+
+void LinkCutTree::push(int x){
+    if (!nodes[x].flip) return;
+    std::swap(nodes[x].child[0], nodes[x].child[1]);
+    for (int k = 0; k < 2; ++k){
+        int c = nodes[x].child[k];
+        if (c != -1) nodes[c].flip = !nodes[c].flip;
+    }
+    nodes[x].flip = false;
+}
+
+void LinkCutTree::pull(int x){
+    nodes[x].best = x;
+    for (int k = 0; k < 2; ++k){
+        int c = nodes[x].child[k];
+        if (c != -1 && nodes[nodes[c].best].cost > nodes[nodes[x].best].cost){
+            nodes[x].best = nodes[c].best;
         }
-        visited.insert(curr);
+    }
+}
 
-        if (pq.empty())
-            break;
+void LinkCutTree::rotate(int x){
+    int p = nodes[x].parent;
+    int g = nodes[p].parent;
+    int side = (nodes[p].child[1] == x) ? 1 : 0;
+    int moved = nodes[x].child[1 - side];
 
+    if (!isRoot(p)){
+        nodes[g].child[nodes[g].child[1] == p ? 1 : 0] = x;
     }
+    nodes[x].parent = g;
+    nodes[x].child[1 - side] = p;
+    nodes[p].parent = x;
+    nodes[p].child[side] = moved;
+    if (moved != -1) nodes[moved].parent = p;
+    pull(p);
+    pull(x);
 }
 
-Graph Prim::getMST() const{
+void LinkCutTree::splay(int x){
+
+    stack.assign(1, x);
+    for (int y = x; !isRoot(y); y = nodes[y].parent){
+        stack.push_back(nodes[y].parent);
+    }
+    while (!stack.empty()){
+        push(stack.back());
+        stack.pop_back();
+    }
+
+    while (!isRoot(x)){
+        int p = nodes[x].parent;
+        if (!isRoot(p)){
+            int g = nodes[p].parent;
+            bool zigzig = (nodes[g].child[0] == p) == (nodes[p].child[0] == x);
+            rotate(zigzig ? p : x);
+        }
+        rotate(x);
+    }
+}
+
+void LinkCutTree::access(int x){
+    int last = -1;
+    for (int y = x; y != -1; y = nodes[y].parent){
+        splay(y);
+        nodes[y].child[1] = last;
+        pull(y);
+        last = y;
+    }
+    splay(x);
+}
+
+void LinkCutTree::makeRoot(int x){
+    access(x);
+    nodes[x].flip = !nodes[x].flip;
+    push(x);
+}
+
+int LinkCutTree::findRoot(int x){
+    access(x);
+    int root = x;
+    push(root);
+    while (nodes[root].child[0] != -1){
+        root = nodes[root].child[0];
+        push(root);
+    }
+    splay(root);
+    return root;
+}
+
+// =====================================================================
+// DynamicMST class: keeps a minimum spanning forest current while edges
+// are inserted and costs change, starting from the tree of a Prim run.
+// The tree lives in a LinkCutTree with one node per tree edge, so an
+// edge outside the tree is handled with the cycle property: it replaces
+// the heaviest edge on the tree path between its endpoints when it is 
+// lighter, in O(log V). A cheaper tree edge only changes the cost. A 
+// dearer tree edge is cut and the lightest edge across the cut takes 
+// its place, which scans the edges of the smaller of the two halves.
+// =====================================================================
+
+class DynamicMST{
+public:
+    DynamicMST(Graph *graph, const Prim &prim); // prim spanned graph (run on a connected graph, or runForest); graph receives the edits
+    void insertEdge(int x, int y, double c); // adds the edge, or sets its cost if already there
+    void setEdgeCost(int x, int y, double c);
+    Graph getMST() const;
+    double getMSTCost() const;
+
+private:
+    void offerEdge(int x, int y, double c);
+    void addTreeEdge(int x, int y, double c);
+    void removeTreeEdge(int x, int y);
+    void replaceTreeEdge(int x, int y);
+    Graph *g;
+    Graph MST;
+    double MSTCost;
+    LinkCutTree forest; // vertices first, then one node per tree edge
+    std::map<std::pair<int, int>, int> edgeNodes; // tree edge (x, y), x < y, to its node
+    std::vector<std::pair<int, int>> endpoints; // tree edge of each edge node
+    std::vector<int> freeNodes; // edge nodes not in use
+    std::vector<char> side; // scratch marks of replaceTreeEdge
+};
+
+DynamicMST::DynamicMST(Graph *graph, const Prim &prim){
+    
+    g = graph;
+    int n = g->V();
+    MST = Graph(n);
+    MSTCost = 0.0;
+    // a spanning forest never has more than n - 1 edges
+    forest.reset(2 * n);
+    endpoints.assign(2 * n, std::make_pair(-1, -1));
+    for (int k = 2 * n - 1; k >= n; --k){
+        freeNodes.push_back(k);
+    }
+    side.assign(n, 0);
+
+    for (const WeightedEdge& we : undirectedEdges(prim.getMST())){
+        addTreeEdge(we.from, we.to, we.cost);
+    }
+}
+
+void DynamicMST::insertEdge(int x, int y, double c){
+
+    if (x == y) return;
+    if (g->adjacent(x, y)){
+        setEdgeCost(x, y, c);
+        return;
+    }
+    g->addEdge(x, y, c);
+    offerEdge(x, y, c);
+}
+
+void DynamicMST::setEdgeCost(int x, int y, double c){
+
+    if (!g->adjacent(x, y)) return;
+    double old = g->getEdgeCost(x, y);
+    g->setEdgeCost(x, y, c);
+
+    auto it = edgeNodes.find(std::make_pair(std::min(x, y), std::max(x, y)));
+    if (it == edgeNodes.end()){
+        // an edge outside the tree only matters when it gets lighter
+        if (c < old){
+            offerEdge(x, y, c);
+        }
+        return;
+    }
+
+    forest.setCost(it->second, c);
+    MST.setEdgeCost(x, y, c);
+    MSTCost += c - old;
+    if (c > old){
+        replaceTreeEdge(x, y);
+    }
+}
+
+Graph DynamicMST::getMST() const{
     return MST;
 }
 
-double Prim::getMSTCost() const{
+double DynamicMST::getMSTCost() const{
     return MSTCost;
 }
 
+// Cycle property: x - y enters the forest if it joins two trees or is
+// lighter than the heaviest edge on the tree path between x and y.
+void DynamicMST::offerEdge(int x, int y, double c){
+
+    if (!forest.connected(x, y)){
+        addTreeEdge(x, y, c);
+        return;
+    }
+    int heaviest = forest.pathMax(x, y);
+    if (forest.getCost(heaviest) > c){
+        removeTreeEdge(endpoints[heaviest].first, endpoints[heaviest].second);
+        addTreeEdge(x, y, c);
+    }
+}
+
+void DynamicMST::addTreeEdge(int x, int y, double c){
+    int node = freeNodes.back();
+    freeNodes.pop_back();
+    edgeNodes[std::make_pair(std::min(x, y), std::max(x, y))] = node;
+    endpoints[node] = std::make_pair(x, y);
+    forest.setCost(node, c);
+    forest.link(x, node);
+    forest.link(node, y);
+    MST.addEdge(x, y, c);
+    MSTCost += c;
+}
+
+void DynamicMST::removeTreeEdge(int x, int y){
+    auto it = edgeNodes.find(std::make_pair(std::min(x, y), std::max(x, y)));
+    int node = it->second;
+    edgeNodes.erase(it);
+    forest.cut(x, node);
+    forest.cut(node, y);
+    forest.setCost(node, -std::numeric_limits<double>::infinity());
+    freeNodes.push_back(node);
+    MSTCost -= MST.getEdgeCost(x, y);
+    MST.removeEdge(x, y);
+}
+
+// Cuts the tree edge x - y and reconnects the two halves with the 
+// lightest graph edge between them, x - y itself when nothing is 
+// lighter. The halves are explored in lockstep so that only the 
+// smaller one is walked in full.
+void DynamicMST::replaceTreeEdge(int x, int y){
+
+    removeTreeEdge(x, y);
+
+    std::vector<int> halves[2] = {std::vector<int>(1, x), std::vector<int>(1, y)};
+    size_t next[2] = {0, 0};
+    side[x] = 1;
+    side[y] = 2;
+    int smaller = -1;
+    while (smaller == -1){
+        for (int h = 0; h < 2 && smaller == -1; ++h){
+            if (next[h] == halves[h].size()){
+                smaller = h;
+                break;
+            }
+            int curr = halves[h][next[h]++];
+            for (int w : MST.neighbors(curr)){
+                if (!side[w]){
+                    side[w] = static_cast<char>(h + 1);
+                    halves[h].push_back(w);
+                }
+            }
+        }
+    }
+
+    WeightedEdge best = {x, y, g->getEdgeCost(x, y)};
+    char mark = static_cast<char>(smaller + 1);
+    for (int v : halves[smaller]){
+        for (const Edge& e : g->edges(v)){
+            if (side[e.to] != mark && e.cost < best.cost){
+                WeightedEdge we = {v, e.to, e.cost};
+                best = we;
+            }
+        }
+    }
+
+    for (int h = 0; h < 2; ++h){
+        for (int v : halves[h]){
+            side[v] = 0;
+        }
+    }
+    addTreeEdge(best.from, best.to, best.cost);
+}
+
 int main() {
 
-    std::fstream fin("sample_data.txt", std::fstream::in);
-    Graph G(fin);
+    GraphFileLoader loader("sample_data.txt");
+    if (!loader.isOpen()){
+        std::cout << "Cannot read sample_data.txt" << std::endl;
+        return 1;
+    }
+    Graph G;
+    if (!loader.loadGraph(G)){
+        std::cout << "Malformed sample_data.txt" << std::endl;
+        return 1;
+    }
 
     std::cout << "Initial Graph" << std::endl;
     G.printGraph();
     std::cout << std::endl;
 
-    Prim prim(&G);
-    prim.run(0);
+    CSRGraph frozen(G);
+    Prim prim(&frozen);
+    prim.runForest();
 
     Graph MST = prim.getMST();
     double MSTCost = prim.getMSTCost();
@@ -568,8 +2837,9 @@ int main() {
     MST.printGraph();
     std::cout << std::endl;
     std::cout << "Minimum Spanning Tree Cost: " << MSTCost << std::endl;
-
-    fin.close();
+    if (prim.components() > 1){
+        std::cout << "The graph is disconnected: the tree is a forest of " << prim.components() << " trees" << std::endl;
+    }
 
     return 0;
 }
@@ -7,14 +7,23 @@
    The HexStatus enum represents the status of a hexagon cell (EMPTY, BLUE, RED).
    The Player enum represents the current player (BLUE, RED).
 
-   The Hex struct represents a hexagon cell with its coordinates, status, and neighboring edges.
+   The Bitboard struct stores one bit per hexagon cell, so a whole color fits in a few words and
+   the board is updated and searched with bitwise operations.
+
+   The Playout class plays random games to the end from a fixed position without touching the
+   board, as the AI needs thousands of them per candidate move.
 
    The HexBoard class defines the game board, including methods for playing, printing, checking
    for a winner, and handling player and AI moves.
 
    The main function initializes the game by specifying the board size and starts the HexBoard game.
 
-    The AI chooses the next moves based on a MonteCarlo simulation.
+    The AI chooses the next moves based on a MonteCarlo simulation, either evaluating every
+    candidate move on every core or growing a search tree (UCT, optionally with RAVE) that puts
+    the playouts on the promising moves and is kept from one turn to the next. Either engine
+    can instead be given a time per move, searching until it runs out.
+
+    Build with: g++ -std=c++11 -O2 -pthread hex.cpp
 
 */
 
@@ -25,11 +34,14 @@
 #include <iomanip>
 #include <random>
 #include <algorithm>
-#include <unordered_map>
-#include <unordered_set>
-#include <stack>
 #include <sstream>
 #include <fstream>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <cmath>
+#include <chrono>
 
 enum class HexStatus {EMPTY, BLUE, RED};
 
@@ -49,6 +61,8 @@ std::ostream& operator<<(std::ostream& out, const HexStatus& s){
 
 enum class Player {BLUE, RED};
 
+enum class Engine {FLAT, UCT, RAVE}; // flat Monte Carlo, tree search, tree search with RAVE
+
 // Overloaded stream insertion operator for Player enum to enable colorful printing.
 std::ostream& operator<<(std::ostream& out, const Player& p){
     if (p == Player::BLUE)
@@ -58,39 +72,502 @@ std::ostream& operator<<(std::ostream& out, const Player& p){
     return out;
 }
 
-// Hex struct representing a hexagon cell with coordinates, status, and neighboring edges.
-struct Hex{
-
-    Hex(){};
-    Hex(unsigned n,unsigned i,unsigned j);
-    unsigned n;
-    HexStatus s;
-    unsigned i, j;
-    std::vector<Hex*> edges;
-    void info();
+// Bitboard struct: one bit per cell, the cell in row i and column j at bit i * stride + j. The
+// stride is the board size plus one guard column that is never set, so a shift by 1 never moves
+// a cell into the next row. The six neighbors of a cell are at -1, +1 (same row), -stride,
+// +stride (same column) and -stride + 1, +stride - 1 (diagonals).
+struct Bitboard{
+
+    static const int WORDS = 7; // 448 bits, enough for 19 rows of stride 20
+    uint64_t w[WORDS];
+    Bitboard();
+    void set(unsigned b);
+    void reset(unsigned b);
+    bool test(unsigned b) const;
+    bool any() const;
+    unsigned count() const;
+    Bitboard shifted(int k) const; // every bit moved by k positions, towards higher bits if k > 0
+    Bitboard neighbors(unsigned stride) const; // cells next to any cell of the board, guards included
+    Bitboard operator|(const Bitboard& o) const;
+    Bitboard operator&(const Bitboard& o) const;
+    Bitboard operator~() const;
+    Bitboard& operator|=(const Bitboard& o);
+    Bitboard& operator&=(const Bitboard& o);
+    bool operator==(const Bitboard& o) const;
 };
 
-// Constructor for Hex struct, initializing its coordinates and status.
-Hex::Hex(unsigned n,unsigned i,unsigned j): n(n), i(i), j(j){
-    s = HexStatus::EMPTY;
+// Constructor for Bitboard struct, starting with no cell set.
+Bitboard::Bitboard(){
+    std::fill(w, w + WORDS, 0);
+}
+
+void Bitboard::set(unsigned b){
+    w[b >> 6] |= uint64_t(1) << (b & 63);
+}
+
+void Bitboard::reset(unsigned b){
+    w[b >> 6] &= ~(uint64_t(1) << (b & 63));
 }
 
-// Overloaded stream insertion operator for Hex struct to enable printing its status.
-std::ostream& operator<<(std::ostream& out, const Hex& h){
-    out << h.s;
+bool Bitboard::test(unsigned b) const{
+    return (w[b >> 6] >> (b & 63)) & 1;
+}
+
+bool Bitboard::any() const{
+    uint64_t acc = 0;
+    for (int i = 0; i < WORDS; ++i)
+        acc |= w[i];
+    return acc != 0;
+}
+
+unsigned Bitboard::count() const{
+    unsigned c = 0;
+    for (int i = 0; i < WORDS; ++i){
+        uint64_t x = w[i];
+        while (x){
+            x &= x - 1;
+            c++;
+        }
+    }
+    return c;
+}
+
+// Shift of the whole multi-word bitset, |k| < 64; bits moved past either end are dropped.
+Bitboard Bitboard::shifted(int k) const{
+    Bitboard out;
+    if (k > 0){
+        for (int i = 0; i < WORDS; ++i)
+            out.w[i] = (w[i] << k) | (i > 0 ? w[i-1] >> (64 - k) : 0);
+    } else if (k < 0){
+        k = -k;
+        for (int i = 0; i < WORDS; ++i)
+            out.w[i] = (w[i] >> k) | (i + 1 < WORDS ? w[i+1] << (64 - k) : 0);
+    } else {
+        out = *this;
+    }
     return out;
 }
 
-// Print detailed information about a Hex cell.
-void Hex::info(){
-    std::cout << "N: " << std::setw(2) << n << " | ";
-    std::cout << "S: " << s << " | ";
-    std::cout << "Coord: (" << i << ',' << j << ')' << " | ";
-    std::cout << "Edges: ";
-    for (const auto& e : edges){
-        std::cout << '(' << e->i << ',' << e->j << ") ";
+Bitboard Bitboard::neighbors(unsigned stride) const{
+    int s = static_cast<int>(stride);
+    return shifted(1) | shifted(-1) | shifted(s) | shifted(-s) | shifted(s - 1) | shifted(-(s - 1));
+}
+
+Bitboard Bitboard::operator|(const Bitboard& o) const{
+    Bitboard out;
+    for (int i = 0; i < WORDS; ++i)
+        out.w[i] = w[i] | o.w[i];
+    return out;
+}
+
+Bitboard Bitboard::operator&(const Bitboard& o) const{
+    Bitboard out;
+    for (int i = 0; i < WORDS; ++i)
+        out.w[i] = w[i] & o.w[i];
+    return out;
+}
+
+Bitboard Bitboard::operator~() const{
+    Bitboard out;
+    for (int i = 0; i < WORDS; ++i)
+        out.w[i] = ~w[i];
+    return out;
+}
+
+Bitboard& Bitboard::operator|=(const Bitboard& o){
+    for (int i = 0; i < WORDS; ++i)
+        w[i] |= o.w[i];
+    return *this;
+}
+
+Bitboard& Bitboard::operator&=(const Bitboard& o){
+    for (int i = 0; i < WORDS; ++i)
+        w[i] &= o.w[i];
+    return *this;
+}
+
+bool Bitboard::operator==(const Bitboard& o) const{
+    return std::equal(w, w + WORDS, o.w);
+}
+
+// Playout class: random games played from one position, like randomize() followed by check()
+// but on its own copy of the stones. A full board has exactly one winner, so only the blue
+// stones are dealt and flood filled: Blue wins if they connect, Red otherwise. Dealing them is
+// a partial shuffle of the empty cells that stops after Blue's share.
+class Playout{
+    public:
+        Playout(unsigned size, unsigned stride);
+        void setup(const Bitboard& blue, const Bitboard& red, const Player& last); // position to play from, last moved last
+        Player run(std::mt19937& g); // plays one random game and returns the winner
+        const Bitboard& blueStones() const; // blue stones at the end of the last game
+    private:
+        unsigned stride;
+        Bitboard bottomRow, topRow;
+        Bitboard baseBlue; // blue stones of the position
+        Bitboard own; // blue stones of the last game
+        std::vector<unsigned> empty; // bits of the empty cells
+        unsigned forBlue; // empty cells that go to Blue
+};
+
+// Constructor for Playout class, building the masks of Blue's sides.
+Playout::Playout(unsigned size, unsigned stride): stride(stride){
+    for (unsigned j = 0; j < size; ++j){
+        topRow.set(j);
+        bottomRow.set((size - 1) * stride + j);
+    }
+    forBlue = 0;
+}
+
+// The empty cells are split as in randomize(): the player that did not move last gets the odd one.
+void Playout::setup(const Bitboard& blue, const Bitboard& red, const Player& last){
+
+    baseBlue = blue;
+    empty.clear();
+    unsigned size = stride - 1;
+    for (unsigned i = 0; i < size; ++i){
+        for (unsigned j = 0; j < size; ++j){
+            unsigned b = i * stride + j;
+            if (!blue.test(b) && !red.test(b))
+                empty.push_back(b);
+        }
+    }
+    forBlue = empty.size() / 2;
+    if (empty.size() % 2 != 0 && last == Player::RED)
+        forBlue++;
+}
+
+Player Playout::run(std::mt19937& g){
+
+    // picks scale a 32 bit draw to the range; the bias, below range / 2^32, is far under the
+    // sampling noise of the playouts
+    own = baseBlue;
+    uint64_t m = empty.size();
+    for (unsigned k = 0; k < forBlue; ++k){
+        uint64_t r = static_cast<uint32_t>(g());
+        std::swap(empty[k], empty[k + ((r * (m - k)) >> 32)]);
+        own.set(empty[k]);
+    }
+
+    Bitboard reached = own & bottomRow;
+    while (reached.any()){
+        if ((reached & topRow).any())
+            return Player::BLUE;
+        Bitboard next = reached | (reached.neighbors(stride) & own);
+        if (next == reached)
+            break;
+        reached = next;
+    }
+    return Player::RED;
+}
+
+const Bitboard& Playout::blueStones() const{
+    return own;
+}
+
+// WorkQueues class: one deque of task indices per worker thread, dealt in contiguous blocks.
+// A worker takes its own tasks from the back and, once it runs out, steals from the front of
+// the others, so uneven tasks (e.g. playouts near a crowded corner end sooner) still balance.
+class WorkQueues{
+    public:
+        WorkQueues(unsigned workers, unsigned tasks);
+        bool next(unsigned worker, unsigned& task); // false when every queue is empty
+    private:
+        std::vector<std::deque<unsigned>> queues;
+        std::vector<std::mutex> locks;
+};
+
+// Constructor for WorkQueues class, dealing the tasks [0, tasks) to the workers.
+WorkQueues::WorkQueues(unsigned workers, unsigned tasks): queues(workers), locks(workers){
+    for (unsigned w = 0; w < workers; ++w){
+        for (unsigned t = tasks * w / workers; t < tasks * (w + 1) / workers; ++t)
+            queues[w].push_back(t);
+    }
+}
+
+bool WorkQueues::next(unsigned worker, unsigned& task){
+    unsigned n = queues.size();
+    for (unsigned k = 0; k < n; ++k){
+        unsigned victim = (worker + k) % n;
+        std::lock_guard<std::mutex> guard(locks[victim]);
+        if (queues[victim].empty())
+            continue;
+        if (k == 0){
+            task = queues[victim].back();
+            queues[victim].pop_back();
+        } else {
+            task = queues[victim].front();
+            queues[victim].pop_front();
+        }
+        return true;
+    }
+    return false;
+}
+
+// TreeSearch class: Monte Carlo tree search with UCT selection. Every playout walks down the
+// tree from the current position picking the child with the best upper confidence bound, adds
+// the children of the leaf once it has been visited often enough, and plays the rest of the game
+// with a Playout. Playouts thus go mostly to the promising moves instead of being spread evenly.
+// With RAVE on, each move also collects the results of the playouts in which its player took
+// its cell at any later point (all moves as first), a noisy but quick estimate that is blended
+// with the real one and phased out as the move gets visited. The tree is kept between turns.
+class TreeSearch{
+    public:
+        TreeSearch();
+        TreeSearch(unsigned size, unsigned stride);
+        void setRave(bool on);
+        void sync(const Bitboard& blue, const Bitboard& red, const Player& toMove); // moves the root to the position
+        void search(std::mt19937& g, unsigned playouts, double seconds); // stops at the first budget spent, 0 for none
+        unsigned bestMove() const; // bit of the most visited move from the root
+        double winRate(unsigned b) const; // wins of the move at bit b over its playouts, 0 if never played
+        unsigned rootPlayouts() const;
+        static constexpr double EXPLORATION = 1.0; // weight of the UCT exploration term
+        static constexpr double RAVE_EXPLORATION = 0.2; // same with RAVE, whose estimates explore already
+        static constexpr double RAVE_EQUIVALENCE = 300; // visits at which both estimates weigh the same
+        static const unsigned EXPAND_VISITS = 8; // playouts through a leaf before its children are added
+        static const unsigned MAX_NODES = 1 << 21; // nodes kept before the tree stops growing
+    private:
+        struct Node{
+            int move; // bit of the move leading here, -1 at the root
+            int parent;
+            int firstChild; // children are contiguous, -1 until expanded
+            int children;
+            unsigned visits;
+            unsigned wins; // playouts won by the player that made the move
+            unsigned amafVisits;
+            unsigned amafWins;
+        };
+        void reset();
+        void reroot(int child);
+        void expand(int n, const Bitboard& b, const Bitboard& r, std::mt19937& g);
+        int select(int n) const;
+        void iterate(std::mt19937& g);
+        unsigned stride = 1;
+        Bitboard cells;
+        Bitboard rootBlue, rootRed; // position at the root
+        Player rootToMove = Player::BLUE;
+        bool rave = false;
+        std::vector<Node> nodes; // nodes[0] is the root
+        std::vector<int> path; // nodes visited by the current playout
+        Playout playout{0, 1};
+};
+
+constexpr double TreeSearch::EXPLORATION;
+constexpr double TreeSearch::RAVE_EXPLORATION;
+constexpr double TreeSearch::RAVE_EQUIVALENCE;
+
+// Default constructor for TreeSearch class, a search over a board with no cells.
+TreeSearch::TreeSearch(): TreeSearch(0, 1){
+}
+
+// Constructor for TreeSearch class, starting from the empty board with Blue to move.
+TreeSearch::TreeSearch(unsigned size, unsigned stride): stride(stride), playout(size, stride){
+    for (unsigned i = 0; i < size; ++i){
+        for (unsigned j = 0; j < size; ++j)
+            cells.set(i * stride + j);
+    }
+    reset();
+}
+
+void TreeSearch::setRave(bool on){
+    rave = on;
+}
+
+void TreeSearch::reset(){
+    nodes.assign(1, Node{-1, -1, -1, 0, 0, 0, 0, 0});
+}
+
+// Make a child of the root the new root, copying its subtree to the front of the pool so the
+// rest of the old tree is freed.
+void TreeSearch::reroot(int child){
+
+    std::vector<Node> kept(1, nodes[child]);
+    kept[0].move = -1;
+    kept[0].parent = -1;
+    for (size_t k = 0; k < kept.size(); ++k){
+        int first = kept[k].firstChild;
+        if (first == -1)
+            continue;
+        int n = kept[k].children;
+        kept[k].firstChild = kept.size();
+        for (int i = 0; i < n; ++i){
+            Node c = nodes[first + i];
+            c.parent = k;
+            kept.push_back(c);
+        }
+    }
+    nodes.swap(kept);
+}
+
+// The moves played since the last search are followed down the tree, so what was learned about
+// the position reached is kept; if one of them was never expanded, or the position is not a
+// continuation of the root, the search starts over.
+void TreeSearch::sync(const Bitboard& blue, const Bitboard& red, const Player& toMove){
+
+    bool continues = (rootBlue & ~blue).any() == false && (rootRed & ~red).any() == false;
+    Bitboard newBlue = blue & ~rootBlue, newRed = red & ~rootRed;
+
+    while (continues && (newBlue.any() || newRed.any())){
+        Bitboard& played = (rootToMove == Player::BLUE) ? newBlue : newRed;
+        int next = -1;
+        for (int i = 0; nodes[0].firstChild != -1 && i < nodes[0].children; ++i){
+            if (played.test(nodes[nodes[0].firstChild + i].move)){
+                next = nodes[0].firstChild + i;
+                break;
+            }
+        }
+        if (next == -1){
+            continues = false;
+            break;
+        }
+        unsigned b = nodes[next].move;
+        played.reset(b);
+        (rootToMove == Player::BLUE ? rootBlue : rootRed).set(b);
+        rootToMove = (rootToMove == Player::BLUE) ? Player::RED : Player::BLUE;
+        reroot(next);
+    }
+
+    if (!continues || rootToMove != toMove){
+        rootBlue = blue;
+        rootRed = red;
+        rootToMove = toMove;
+        reset();
+    }
+}
+
+// Add one child per empty cell, in random order so that ties between unvisited children are
+// broken at random.
+void TreeSearch::expand(int n, const Bitboard& b, const Bitboard& r, std::mt19937& g){
+
+    Bitboard taken = b | r;
+    int first = nodes.size();
+    for (unsigned i = 0; i < Bitboard::WORDS * 64; ++i){
+        if (cells.test(i) && !taken.test(i))
+            nodes.push_back(Node{static_cast<int>(i), n, -1, 0, 0, 0, 0, 0});
+    }
+    std::shuffle(nodes.begin() + first, nodes.end(), g);
+    nodes[n].firstChild = first;
+    nodes[n].children = nodes.size() - first;
+}
+
+// Child of n with the best upper confidence bound, seen from the player to move at n.
+int TreeSearch::select(int n) const{
+
+    const Node& parent = nodes[n];
+    double logVisits = std::log(std::max(1u, parent.visits));
+    int best = parent.firstChild;
+    double bestValue = -1;
+
+    for (int c = parent.firstChild; c < parent.firstChild + parent.children; ++c){
+        const Node& child = nodes[c];
+        double value;
+        if (rave){
+            double mean = child.visits ? double(child.wins) / child.visits : 0.5;
+            double amaf = child.amafVisits ? double(child.amafWins) / child.amafVisits : 0.5;
+            double beta = std::sqrt(RAVE_EQUIVALENCE / (3 * child.visits + RAVE_EQUIVALENCE));
+            value = (1 - beta) * mean + beta * amaf
+                  + RAVE_EXPLORATION * std::sqrt(logVisits / (child.visits + 1));
+        } else {
+            if (child.visits == 0)
+                return c;
+            value = double(child.wins) / child.visits + EXPLORATION * std::sqrt(logVisits / child.visits);
+        }
+        if (value > bestValue){
+            bestValue = value;
+            best = c;
+        }
+    }
+    return best;
+}
+
+// One playout: selection, expansion, random game, then the result goes back up the path.
+void TreeSearch::iterate(std::mt19937& g){
+
+    Bitboard b = rootBlue, r = rootRed;
+    Player toMove = rootToMove;
+    int n = 0;
+    path.assign(1, 0);
+
+    while (true){
+        if (nodes[n].firstChild == -1){
+            bool grow = (n == 0 || nodes[n].visits >= EXPAND_VISITS) && nodes.size() < MAX_NODES;
+            if (!grow)
+                break;
+            expand(n, b, r, g);
+        }
+        if (nodes[n].children == 0)
+            break;
+        n = select(n);
+        (toMove == Player::BLUE ? b : r).set(nodes[n].move);
+        toMove = (toMove == Player::BLUE) ? Player::RED : Player::BLUE;
+        path.push_back(n);
+        if (nodes[n].visits == 0)
+            break;
+    }
+
+    Player last = (toMove == Player::BLUE) ? Player::RED : Player::BLUE;
+    playout.setup(b, r, last);
+    Player winner = playout.run(g);
+    const Bitboard& finalBlue = playout.blueStones();
+
+    // path[k] is reached after k moves, so its move was made by the root player when k is odd
+    for (size_t k = 0; k < path.size(); ++k){
+        Node& node = nodes[path[k]];
+        Player mover = (k % 2 == 1) ? rootToMove : (rootToMove == Player::BLUE ? Player::RED : Player::BLUE);
+        node.visits++;
+        if (mover == winner)
+            node.wins++;
+
+        if (!rave || node.firstChild == -1)
+            continue;
+        Player next = (mover == Player::BLUE) ? Player::RED : Player::BLUE;
+        bool nextBlue = (next == Player::BLUE);
+        for (int c = node.firstChild; c < node.firstChild + node.children; ++c){
+            if (finalBlue.test(nodes[c].move) == nextBlue){
+                nodes[c].amafVisits++;
+                if (next == winner)
+                    nodes[c].amafWins++;
+            }
+        }
+    }
+}
+
+void TreeSearch::search(std::mt19937& g, unsigned playouts, double seconds){
+
+    if (playouts == 0 && seconds <= 0)
+        return;
+
+    // the clock is read every 64 playouts, a small fraction of a millisecond on any board; the
+    // first playout always runs, so the root has children to choose from however short the time
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; playouts == 0 || i < playouts; ++i){
+        if (seconds > 0 && i > 0 && i % 64 == 0){
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= seconds)
+                break;
+        }
+        iterate(g);
     }
-    std::cout << std::endl;
+}
+
+unsigned TreeSearch::bestMove() const{
+    int best = nodes[0].firstChild;
+    for (int c = nodes[0].firstChild; c < nodes[0].firstChild + nodes[0].children; ++c){
+        if (nodes[c].visits > nodes[best].visits)
+            best = c;
+    }
+    return nodes[best].move;
+}
+
+double TreeSearch::winRate(unsigned b) const{
+    for (int c = nodes[0].firstChild; c < nodes[0].firstChild + nodes[0].children; ++c){
+        if (nodes[c].move == static_cast<int>(b))
+            return nodes[c].visits ? double(nodes[c].wins) / nodes[c].visits : 0;
+    }
+    return 0;
+}
+
+unsigned TreeSearch::rootPlayouts() const{
+    return nodes[0].visits;
 }
 
 // HexBoard class representing the game board and its functionality.
@@ -98,12 +575,13 @@ class HexBoard{
     public:
         HexBoard(){};
         HexBoard(unsigned n);
-        ~HexBoard();
         void Play();
+        static const unsigned MAX_SIZE = 19; // largest board the bitboards can hold
     private:
         void print();
         void printEdgeList();
         void printPlayerEdgeList(const Player& p);
+        void cellInfo(unsigned c);
         void randomize();
         void revertRandom();
         void clear();
@@ -112,59 +590,76 @@ class HexBoard{
         void move(const Player& p, const unsigned& x, const unsigned& y, bool verbose = false);
         void undo(const Player& p, const unsigned& x, const unsigned& y);
         unsigned size;
+        unsigned stride; // bits per row, size plus the guard column
         unsigned occupied = 0;
         Player last = Player::BLUE;
-        std::vector<Hex*> edgeList;
-        std::unordered_map<unsigned, Hex*> blueEdgeList, redEdgeList;
-        std::vector<int> randomized;
+        Bitboard blue, red; // cells taken by each player
+        Bitboard cells; // every cell of the board
+        Bitboard topRow, bottomRow, leftColumn, rightColumn;
+        Bitboard randomMask; // cells filled by randomize(), empty if none
+        std::vector<int> randomized; // bits of the cells filled by randomize()
+        std::vector<HexStatus> fill; // colors dealt to the randomized cells
+        std::mt19937 rng;
+        unsigned threads; // workers used by getAIMove
+        Engine engine = Engine::FLAT;
+        TreeSearch tree; // kept across turns by the tree engines
+        double moveTime = 0; // seconds per AI move, 0 to spend the playout budget instead
+        unsigned turnPlayouts = 0; // playouts of the last AI move
+        unsigned long long totalPlayouts = 0;
+        std::vector<double> latencies; // seconds taken by each AI move
+        static const unsigned FLAT_BATCH = 32; // playouts per candidate between deadline checks
+        unsigned bit(const unsigned& x, const unsigned& y) const; // bit of the 1-based cell (x, y)
+        HexStatus status(unsigned b) const;
         bool isOOB(const unsigned& x, const unsigned& y);
         bool isEmpty(const unsigned& x, const unsigned& y);
         void getHumanMove(unsigned& x, unsigned& y);
-        void getAIMove(const Player& p, unsigned& x, unsigned& y, const unsigned& N, bool save = true);
-        int playTurn(const Player& human, const Player& ai, const unsigned& N);
+        void getAIMove(const Player& p, unsigned& x, unsigned& y, const unsigned& N, bool save = true, double seconds = 0);
+        void getTreeMove(const Player& p, unsigned& x, unsigned& y, const unsigned& playouts, bool save = true, double seconds = 0);
+        void getEngineMove(const Player& p, unsigned& x, unsigned& y, const unsigned& budget);
+        void saveAIData(const std::vector<double>& rates);
+        int playTurn(const Player& human, const Player& ai, const unsigned& budget);
         double gwins = 0;
         void printAIConf();
+        void printAITime();
+        void printAITimeSummary();
 };
 
-// Constructor for HexBoard class, initializing the game board based on the specified size.
-HexBoard::HexBoard(unsigned n): size(n){
-
-    int c = 0;
-    edgeList.resize(size * size);
-    for (int i = 0; i < size; ++i){
-        for (int j = 0; j < size; ++j){
-            edgeList[c] = new Hex(c, i, j);
-            if (j > 0){
-                (*edgeList[c]).edges.push_back(edgeList[c-1]);
-                (*edgeList[c-1]).edges.push_back(edgeList[c]);
-            }
-            c++;
-        }
-        if (i > 0){
-            for (int k = 0; k < size; ++k){
-                (*edgeList[k + size * i]).edges.push_back(edgeList[k + size * (i-1)]);
-                (*edgeList[k + size * (i-1)]).edges.push_back(edgeList[k + size * i]);
-                if (k >= 0 && k < size - 1){
-                    (*edgeList[k + size * i]).edges.push_back(edgeList[k + size * (i-1) + 1]);
-                    (*edgeList[k + size * (i-1) + 1]).edges.push_back(edgeList[k + size * i]);
-                }
-            }
+// Constructor for HexBoard class, building the masks of the board and of its four sides.
+HexBoard::HexBoard(unsigned n): size(std::min(n, MAX_SIZE)), stride(size + 1), rng(std::random_device()()), tree(size, stride){
+
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (unsigned i = 0; i < size; ++i){
+        for (unsigned j = 0; j < size; ++j){
+            unsigned b = i * stride + j;
+            cells.set(b);
+            if (i == 0)
+                topRow.set(b);
+            if (i == size - 1)
+                bottomRow.set(b);
+            if (j == 0)
+                leftColumn.set(b);
+            if (j == size - 1)
+                rightColumn.set(b);
         }
     }
 
 }
 
-// Destructor for HexBoard class, freeing allocated memory.
-HexBoard::~HexBoard(){
-    for (auto h : edgeList){
-        delete h;
-    }
-    edgeList.clear();
-    blueEdgeList.clear();
-    redEdgeList.clear();
-    randomized.clear();
-    edgeList.shrink_to_fit();
-    randomized.shrink_to_fit();
+const unsigned HexBoard::MAX_SIZE;
+
+// Bit of the cell in row x and column y, both counted from 1.
+unsigned HexBoard::bit(const unsigned& x, const unsigned& y) const{
+    return (x-1) * stride + (y-1);
+}
+
+// Status of the cell at bit b.
+HexStatus HexBoard::status(unsigned b) const{
+    if (blue.test(b))
+        return HexStatus::BLUE;
+    if (red.test(b))
+        return HexStatus::RED;
+    return HexStatus::EMPTY;
 }
 
 // Check if a cell is out of bounds on the game board.
@@ -174,7 +669,7 @@ bool HexBoard::isOOB(const unsigned& x, const unsigned& y){
 
 // Check if a cell is empty on the game board.
 bool HexBoard::isEmpty(const unsigned& x, const unsigned& y){
-    return (edgeList[(x-1) * size + (y-1)]->s == HexStatus::EMPTY);
+    return status(bit(x, y)) == HexStatus::EMPTY;
 }
 
 // Check if a move is legal on the specified coordinates.
@@ -196,6 +691,7 @@ void HexBoard::print(){
 
     for (int i = 0; i < size * 2; ++i){
 
+        c = (i / 2) * stride;
         if (i % 2 == 0){
             std::cout << std::setw(2) << (i / 2) + 1 << ' ';
         } else {
@@ -207,7 +703,7 @@ void HexBoard::print(){
     
         for (int j = 0; j < size; ++j){
             if (i % 2 == 0){
-                std::cout << (*edgeList[c]);
+                std::cout << status(c);
                 if (j < size - 1)
                     std::cout << " - ";
                 c++;
@@ -223,10 +719,27 @@ void HexBoard::print(){
     }
 }
 
-// Print detailed information about each hexagon cell in the edgeList.
+// Print detailed information about a cell: index, status, coordinates and neighbors.
+void HexBoard::cellInfo(unsigned c){
+    unsigned i = c / size, j = c % size;
+    Bitboard self;
+    self.set(i * stride + j);
+    Bitboard around = self.neighbors(stride) & cells;
+    std::cout << "N: " << std::setw(2) << c << " | ";
+    std::cout << "S: " << status(i * stride + j) << " | ";
+    std::cout << "Coord: (" << i << ',' << j << ')' << " | ";
+    std::cout << "Edges: ";
+    for (unsigned b = 0; b < size * stride; ++b){
+        if (around.test(b))
+            std::cout << '(' << b / stride << ',' << b % stride << ") ";
+    }
+    std::cout << std::endl;
+}
+
+// Print detailed information about each hexagon cell of the board.
 void HexBoard::printEdgeList(){
     for (int i = 0; i < size * size; ++i){
-        edgeList[i]->info();
+        cellInfo(i);
     }
 }
 
@@ -234,11 +747,10 @@ void HexBoard::printEdgeList(){
 void HexBoard::move(const Player& p, const unsigned& x, const unsigned& y, bool verbose){
 
     if (isLegal(x, y)){
-        edgeList[(x-1) * size + (y-1)]->s = static_cast<HexStatus>(static_cast<int>(p) + 1);
         if (p == Player::BLUE)
-            blueEdgeList[(x-1) * size + (y-1)] = edgeList[(x-1) * size + (y-1)];
+            blue.set(bit(x, y));
         else
-            redEdgeList[(x-1) * size + (y-1)] = edgeList[(x-1) * size + (y-1)];
+            red.set(bit(x, y));
         occupied++;
         if (verbose){
             print();
@@ -246,6 +758,7 @@ void HexBoard::move(const Player& p, const unsigned& x, const unsigned& y, bool
             std::cout<< x << "," << y << ')' << std::endl;
         }
         randomized.clear();
+        randomMask = Bitboard();
         last = p;
         return ;
     }
@@ -257,13 +770,14 @@ void HexBoard::move(const Player& p, const unsigned& x, const unsigned& y, bool
 void HexBoard::undo(const Player& p, const unsigned& x, const unsigned& y){
     
     if ((!isOOB(x, y) && !isEmpty(x, y))){
-        edgeList[(x-1) * size + (y-1)]->s = HexStatus::EMPTY;
-        occupied--;
-        if (p == Player::BLUE && edgeList[(x-1) * size + (y-1)]->s == HexStatus::BLUE){
-            blueEdgeList.erase((x-1) * size + (y-1));
+        unsigned b = bit(x, y);
+        if (p == Player::BLUE && blue.test(b)){
+            blue.reset(b);
+            occupied--;
             last = Player::RED;
-        } else if (p == Player::RED && edgeList[(x-1) * size + (y-1)]->s == HexStatus::RED) {
-            redEdgeList.erase((x-1) * size + (y-1));
+        } else if (p == Player::RED && red.test(b)) {
+            red.reset(b);
+            occupied--;
             last = Player::BLUE;
         }       
     }
@@ -272,9 +786,6 @@ void HexBoard::undo(const Player& p, const unsigned& x, const unsigned& y){
 // Randomly assign hexagon cells to players, simulating a game.
 void HexBoard::randomize(){
 
-    std::random_device rd;
-    std::mt19937 g(rd());
-
     if (randomized.size() == 0){
 
         unsigned freeHexes = (size*size) - occupied;
@@ -287,135 +798,78 @@ void HexBoard::randomize(){
                 ForBlue++;
         }
         
-        std::vector<HexStatus> v(ForBlue, HexStatus::BLUE), v1(ForRed, HexStatus::RED);
-        v.insert(v.end(), v1.begin(), v1.end());
-        std::shuffle(v.begin(), v.end(), g);
-
-        int c = 0;
-        randomized.resize(freeHexes);
-        for (int i = 0; i < size * size; ++i){
-            if (edgeList[i]->s == HexStatus::EMPTY){
-                edgeList[i]->s = v[c];
-                if (v[c] == HexStatus::BLUE)
-                    blueEdgeList[i] = edgeList[i];
-                else
-                    redEdgeList[i] = edgeList[i];
-                randomized[c] = i;
-                c++;
-            }
+        fill.assign(ForBlue, HexStatus::BLUE);
+        fill.insert(fill.end(), ForRed, HexStatus::RED);
+
+        Bitboard empty = cells & ~(blue | red);
+        randomized.clear();
+        for (unsigned b = 0; b < size * stride; ++b){
+            if (empty.test(b))
+                randomized.push_back(b);
         }
+        randomMask = empty;
 
     } else {
 
-        std::vector<HexStatus> v(randomized.size());
-        for (int i = 0; i < randomized.size(); ++i){
-            v[i] = edgeList[randomized[i]]->s;
-        }
+        blue &= ~randomMask;
+        red &= ~randomMask;
 
-        std::shuffle(v.begin(), v.end(), g);
-        for (int i = 0; i < randomized.size(); ++i){
-            if (v[i] != edgeList[randomized[i]]->s){
-                if (v[i] == HexStatus::BLUE){
-                    redEdgeList.erase(randomized[i]);
-                    blueEdgeList[randomized[i]] = edgeList[randomized[i]];
-                } else {
-                    blueEdgeList.erase(randomized[i]);
-                    redEdgeList[randomized[i]] = edgeList[randomized[i]];
-                }
-                edgeList[randomized[i]]->s = v[i];
-            }
-        }
+    }
 
+    std::shuffle(fill.begin(), fill.end(), rng);
+    for (int i = 0; i < randomized.size(); ++i){
+        if (fill[i] == HexStatus::BLUE)
+            blue.set(randomized[i]);
+        else
+            red.set(randomized[i]);
     }
     occupied = size * size;
 }
 
 // Revert the random assignment, undoing the changes made by randomize().
 void HexBoard::revertRandom(){
-    for (const auto& h : randomized){
-
-        if (edgeList[h]->s == HexStatus::BLUE)
-            blueEdgeList.erase(h);
-        else
-            redEdgeList.erase(h);
-
-        edgeList[h]->s = HexStatus::EMPTY;
-        occupied--;
-    }
+    blue &= ~randomMask;
+    red &= ~randomMask;
+    occupied -= randomized.size();
 }
 
 // Clear the game board, resetting it to its initial state.
 void HexBoard::clear(){
-    for (int i = 0; i < size * size; ++i){
-        edgeList[i]->s = HexStatus::EMPTY;
-    }
-    blueEdgeList.clear();
-    redEdgeList.clear();
+    blue = Bitboard();
+    red = Bitboard();
+    randomMask = Bitboard();
     randomized.clear();
     occupied = 0;
 }
 
-// Print detailed information about each hexagon cell of a specific player in their edgeList.
+// Print detailed information about each hexagon cell of a specific player.
 void HexBoard::printPlayerEdgeList(const Player& p){
-    if (p == Player::BLUE){
-        for (auto& e : blueEdgeList){
-            (e.second)->info();
-        }
-    } else {
-        for (auto& e : redEdgeList){
-            (e.second)->info();
-        }
+    const Bitboard& own = (p == Player::BLUE) ? blue : red;
+    for (unsigned c = 0; c < size * size; ++c){
+        if (own.test((c / size) * stride + c % size))
+            cellInfo(c);
     }
 }
 
-// Check if a player has won the game by connecting their respective sides.
+// Check if a player has won the game by connecting their respective sides: a flood fill from
+// the first side that grows one step per iteration through the shifted neighbor masks.
 bool HexBoard::check(const Player& p){
 
-    std::unordered_set<unsigned> end_nodes;
-    std::stack<unsigned> Q;
-
-    unsigned B = static_cast<unsigned>(p == Player::BLUE);
-    for (int i = 0; i < size; ++i){
-
-        if (B) {
-            if (blueEdgeList.count(size*(size - 1) + i))
-                Q.push(size*(size - 1) + i);
-            if (blueEdgeList.count(i))
-                end_nodes.insert(i);
-        } else {
-            if (redEdgeList.count(i*size))
-                Q.push(i*size);
-            if (redEdgeList.count(i*size + size - 1))
-                end_nodes.insert(i*size + size - 1);
-        }
-    }
-
-    bool w = false;
-    HexStatus I = (B != 0) ? HexStatus::BLUE : HexStatus::RED;
-    std::unordered_set<unsigned> visited, queued;
-    if (!Q.empty() && (end_nodes.size() > 0)){
-
-        while (!Q.empty() && !w){
+    bool B = (p == Player::BLUE);
+    const Bitboard& own = B ? blue : red;
+    const Bitboard& goal = B ? topRow : rightColumn;
+    Bitboard reached = own & (B ? bottomRow : leftColumn);
 
-            auto top = Q.top();
-            Q.pop();
-            visited.insert(top);
-            queued.erase(top);
-
-            for (const auto& e : edgeList[top]->edges){
-                if ((e->s == I) && !visited.count(e->n) && !queued.count(e->n)){
-                    if (end_nodes.count(e->n)){
-                        w = !w;
-                        break;
-                    }
-                    Q.push(e->n);
-                    queued.insert(e->n);
-                }
-            }
-        }
+    while (reached.any()){
+        if ((reached & goal).any())
+            return true;
+        Bitboard next = reached | (reached.neighbors(stride) & own);
+        if (next == reached)
+            break;
+        reached = next;
     }
 
-    return w;
+    return false;
 }
 
 // Get a move from the human player.
@@ -429,64 +883,156 @@ void HexBoard::getHumanMove(unsigned& x, unsigned& y){
         std::cin >> y;
 }
 
-// Get a move from the AI player based on specified difficulty and number of simulations.
-void HexBoard::getAIMove(const Player& p, unsigned& x, unsigned& y, const unsigned& N, bool save){
-
-    std::ofstream of;
-    static int turn = 0;
-    if (save){    
-        std::string file_name = "aidata" + std::to_string(turn) + ".txt";
-        of.open(file_name);
-        of << "turn,x,y,conf" << std::endl; 
+// Get a move from the AI player based on specified difficulty and number of simulations. The legal
+// moves are evaluated in parallel, each worker with its own Playout, and every move draws its
+// games from a generator seeded by the turn seed and the move, so the table of win rates does
+// not depend on the number of threads or on which thread evaluated what.
+// Given seconds > 0 the search is anytime instead: the candidates get FLAT_BATCH playouts each,
+// round after round, until the time is up, and the move with the best rate so far is played.
+void HexBoard::getAIMove(const Player& p, unsigned& x, unsigned& y, const unsigned& N, bool save, double seconds){
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    bool timed = seconds > 0;
+
+    std::vector<unsigned> candidates;
+    for (unsigned i = 0; i < size*size; ++i){
+        if (isLegal(i / size + 1, i % size + 1))
+            candidates.push_back(i);
     }
 
-    unsigned tx, ty;
-    double wins = 0;
-    gwins = 0;
-    for (int i = 0; i < size*size; ++i){
-        
-        tx = i / size + 1;
-        ty = i % size + 1;
-
-        if (isLegal(tx, ty)){
+    uint32_t seed = rng();
+    std::vector<std::mt19937> gens;
+    for (unsigned i : candidates){
+        std::seed_seq sequence{seed, static_cast<uint32_t>(i)};
+        gens.emplace_back(sequence);
+    }
 
-            wins = 0;
-            move(p, tx, ty);
-            for (int j = 0; j < N; ++j){
-                randomize();
-                if (check(p))
-                    wins++;
-            }
-            wins /= N;
-            if (gwins < wins){
-                gwins = wins;
-                x = tx;
-                y = ty;
+    std::vector<unsigned> won(size*size, 0), played(size*size, 0);
+    unsigned batch = timed ? FLAT_BATCH : N;
+    unsigned workers = std::max(1u, std::min<unsigned>(threads, candidates.size()));
+
+    do {
+        WorkQueues queues(workers, candidates.size());
+
+        auto worker = [&](unsigned w){
+            Playout playout(size, stride);
+            unsigned task;
+            while (queues.next(w, task)){
+                if (timed && std::chrono::steady_clock::now() >= deadline)
+                    break;
+                unsigned i = candidates[task];
+                Bitboard b = blue, r = red;
+                (p == Player::BLUE ? b : r).set(bit(i / size + 1, i % size + 1));
+                playout.setup(b, r, p);
+
+                for (unsigned j = 0; j < batch; ++j){
+                    if (playout.run(gens[task]) == p)
+                        won[i]++;
+                }
+                played[i] += batch;
             }
-            revertRandom();
-            undo(p, tx, ty);
+        };
+
+        std::vector<std::thread> pool;
+        for (unsigned w = 1; w < workers; ++w)
+            pool.emplace_back(worker, w);
+        worker(0);
+        for (auto& t : pool)
+            t.join();
+
+    } while (timed && std::chrono::steady_clock::now() < deadline);
+
+    std::vector<double> rates(size*size, 0.0);
+    turnPlayouts = 0;
+    for (unsigned i : candidates){
+        if (played[i] > 0)
+            rates[i] = static_cast<double>(won[i]) / played[i];
+        turnPlayouts += played[i];
+    }
 
-            if (save)
-                of << turn << ',' << tx  << ',' << ty << ',' << wins << std::endl;
-        
-        } else {
-            
-            if (save){
-                of << turn << "," << tx << ',' << ty << ',';
-                of << 100 + static_cast<int>(edgeList[i]->s) << std::endl;
-            }
-        
+    // a deadline too short for any playout still gets a legal move
+    x = candidates[0] / size + 1;
+    y = candidates[0] % size + 1;
+    gwins = 0;
+    for (unsigned i : candidates){
+        if (gwins < rates[i]){
+            gwins = rates[i];
+            x = i / size + 1;
+            y = i % size + 1;
         }
-        
     }
+    if (save)
+        saveAIData(rates);
+}
+
+// Get a move from the tree search engine, spending the playouts on top of what the tree kept
+// from the previous turns, and play the most visited one. Given seconds > 0 the search runs
+// until that much time has passed since the call, following the tree included.
+void HexBoard::getTreeMove(const Player& p, unsigned& x, unsigned& y, const unsigned& playouts, bool save, double seconds){
+
+    auto start = std::chrono::steady_clock::now();
+    tree.setRave(engine == Engine::RAVE);
+    tree.sync(blue, red, p);
+    unsigned before = tree.rootPlayouts();
+
+    std::chrono::duration<double> spent = std::chrono::steady_clock::now() - start;
+    tree.search(rng, playouts, seconds > 0 ? std::max(seconds - spent.count(), 1e-6) : 0);
+    turnPlayouts = tree.rootPlayouts() - before;
+
+    unsigned b = tree.bestMove();
+    x = b / stride + 1;
+    y = b % stride + 1;
+    gwins = tree.winRate(b);
+
     if (save){
-        turn++;
-        of.close();
+        std::vector<double> rates(size*size, 0.0);
+        for (unsigned i = 0; i < size*size; ++i)
+            rates[i] = tree.winRate(bit(i / size + 1, i % size + 1));
+        saveAIData(rates);
+    }
+}
+
+// Get a move from the engine chosen in Play(), with its budget: playouts per candidate move for
+// the flat engine, playouts per turn for the tree engines, or moveTime seconds for either. The
+// time taken is recorded for printAITime().
+void HexBoard::getEngineMove(const Player& p, unsigned& x, unsigned& y, const unsigned& budget){
+
+    auto start = std::chrono::steady_clock::now();
+    if (engine == Engine::FLAT)
+        getAIMove(p, x, y, budget, true, moveTime);
+    else
+        getTreeMove(p, x, y, budget, true, moveTime);
+
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    latencies.push_back(took.count());
+    totalPlayouts += turnPlayouts;
+}
+
+// Write the win rates of the AI turn to aidata<turn>.txt, the status of the taken cells plus
+// 100 in place of a rate.
+void HexBoard::saveAIData(const std::vector<double>& rates){
+
+    static int turn = 0;
+    std::string file_name = "aidata" + std::to_string(turn) + ".txt";
+    std::ofstream of(file_name);
+    of << "turn,x,y,conf" << std::endl; 
+
+    for (unsigned i = 0; i < size*size; ++i){
+
+        unsigned tx = i / size + 1;
+        unsigned ty = i % size + 1;
+
+        if (isLegal(tx, ty))
+            of << turn << ',' << tx  << ',' << ty << ',' << rates[i] << std::endl;
+        else
+            of << turn << "," << tx << ',' << ty << ',' << 100 + static_cast<int>(status(bit(tx, ty))) << std::endl;
     }
+    turn++;
 }
 
 // Play a turn of the game, alternating between human and AI players.
-int HexBoard::playTurn(const Player& human, const Player& ai, const unsigned& N){
+int HexBoard::playTurn(const Player& human, const Player& ai, const unsigned& budget){
 
     unsigned x, y, aix, aiy;
 
@@ -500,17 +1046,19 @@ int HexBoard::playTurn(const Player& human, const Player& ai, const unsigned& N)
         if (check(human))
             return 0;
 
-        getAIMove(ai, aix, aiy, N);
+        getEngineMove(ai, aix, aiy, budget);
         move(ai, aix, aiy, true);
         printAIConf();
+        printAITime();
         if (check(ai))
             return 1;
 
     } else {
 
-        getAIMove(ai, aix, aiy, N);
+        getEngineMove(ai, aix, aiy, budget);
         move(ai, aix, aiy, true);
         printAIConf();
+        printAITime();
         if (check(ai))
             return 1;
 
@@ -542,31 +1090,53 @@ void HexBoard::Play(){
     Player human = static_cast<Player>(n-1);
     Player ai = (human == Player::BLUE) ? Player::RED : Player::BLUE;
 
+    int e;
+    std::cout << "> " << "Choose AI [Flat Monte Carlo 1, Tree search 2, Tree search with RAVE 3]:" << std::endl;
+    std::cin >> e;
+    std::cin.clear();
+    engine = (e == 2) ? Engine::UCT : (e == 3) ? Engine::RAVE : Engine::FLAT;
+
     int diff;
-    std::cout << "> " << "Choose difficuly [Easy 1, Medium 2, Hard 3]:" << std::endl;
+    std::cout << "> " << "Choose difficuly [Easy 1, Medium 2, Hard 3, Timed 4]:" << std::endl;
     std::cin >> diff;
     std::cin.clear();
 
-    unsigned N = 1025;
+    if (diff == 4){
+        std::cout << "> " << "Seconds per AI move: ";
+        std::cin >> moveTime;
+        std::cin.clear();
+        if (!(moveTime > 0))
+            moveTime = 1;
+    }
+
+    // playouts per candidate move for the flat engine, per turn for the tree engines, which
+    // spend them where they matter whatever the board size
+    unsigned N = 1025, playouts = 100000;
     switch (diff){
         case (1):
             N = 257;
+            playouts = 25000;
             break;
         case (2):
             N = 513;
+            playouts = 50000;
             break;
     }
+    unsigned budget = (engine == Engine::FLAT) ? N : playouts;
+    if (moveTime > 0)
+        budget = 0; // no playout limit, the clock alone ends the search
 
     print();
 
     int result = 2;
     while (result == 2){
-        result = playTurn(human, ai, N);
+        result = playTurn(human, ai, budget);
     }
     
     std::cout << std::endl;
     Player winner = static_cast<Player>(result);    
     std::cout << "> " << winner << " has won!" << std::endl;
+    printAITimeSummary();
 
 }
 
@@ -589,6 +1159,35 @@ void HexBoard::printAIConf(){
 
 }
 
+// Print the time taken by the last AI move and the playouts it ran.
+void HexBoard::printAITime(){
+
+    if (latencies.empty())
+        return;
+    std::cout << "> AI Time: " << std::setprecision(3) << latencies.back() << " s, ";
+    std::cout << turnPlayouts << " playouts" << std::endl;
+
+}
+
+// Print the number of AI moves with their mean and worst time, and the playouts per second.
+void HexBoard::printAITimeSummary(){
+
+    if (latencies.empty())
+        return;
+    double total = 0, worst = 0;
+    for (double t : latencies){
+        total += t;
+        worst = std::max(worst, t);
+    }
+    std::cout << "> AI Moves: " << latencies.size();
+    std::cout << ", mean time: " << std::setprecision(3) << total / latencies.size() << " s";
+    std::cout << ", max time: " << worst << " s";
+    if (total > 0)
+        std::cout << ", playouts/s: " << static_cast<unsigned long long>(totalPlayouts / total);
+    std::cout << std::endl;
+
+}
+
 
 int main(void){
 
@@ -597,7 +1196,7 @@ int main(void){
     std::cin >> size;
     std::cout << std::endl;
 
-    HexBoard HB(std::max(3, size));
+    HexBoard HB(std::min(std::max(3, size), static_cast<int>(HexBoard::MAX_SIZE)));
     HB.Play();
 
     return 0;